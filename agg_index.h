@@ -0,0 +1,272 @@
+#ifndef AGG_INDEX_H
+#define AGG_INDEX_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "even_count.h"
+#include "simd_isa.h"
+#include "simd_sum.h"
+
+// Incrementally maintained sum and even count over an int32 array that
+// changes a few elements at a time. The array is split into AI_BLOCK
+// element blocks; each block keeps its sum and even count, and two Fenwick
+// trees over the blocks give any prefix of those in O(log blocks).
+//
+//   ai_update        one element, eager: writes it and pushes the sum and
+//                    parity deltas into both trees, O(log N)
+//   ai_update_batch  many elements, lazy: the batch is bucketed by the
+//                    thread whose static range of blocks holds each index;
+//                    each thread applies its bucket in batch order (so the
+//                    last write to an element wins, with no races) and
+//                    marks those blocks dirty
+//   ai_refresh       recomputes dirty blocks with the SIMD kernels, then
+//                    patches the trees per block, or rebuilds them in
+//                    O(blocks) once that is cheaper. Queries call it first
+//   ai_range_*       [lo, hi): whole blocks from the trees, the partial
+//                    blocks at either end scanned directly, so a query
+//                    costs O(log N + AI_BLOCK) instead of O(hi - lo)
+//
+// The index does not own the array. Writes made behind its back are not
+// seen until ai_build() runs again.
+
+#ifndef AI_BLOCK
+#define AI_BLOCK 4096   // 16 KB of int32: an edge scan stays in L1
+#endif
+
+typedef struct {
+    int *a;
+    size_t n;
+    size_t nblocks;
+    long long *block_sum;
+    long long *block_even;
+    long long *tree_sum;    // Fenwick trees, 1-based, nblocks + 1 entries
+    long long *tree_even;
+    unsigned char *dirty;
+    size_t ndirty;
+    sum_kernel_fn sum_kernel;
+    even_count_fn even_kernel;
+} ai_index_t;
+
+static inline void ai_tree_add(long long *tree, size_t nblocks, size_t block, long long delta) {
+    for (size_t i = block + 1; i <= nblocks; i += i & (~i + 1)) tree[i] += delta;
+}
+
+// Sum of the first `blocks` block values.
+static inline long long ai_tree_prefix(const long long *tree, size_t blocks) {
+    long long s = 0;
+    for (size_t i = blocks; i > 0; i -= i & (~i + 1)) s += tree[i];
+    return s;
+}
+
+// O(blocks) construction: every node passes its total up to its parent.
+static inline void ai_tree_build(long long *tree, const long long *values, size_t nblocks) {
+    tree[0] = 0;
+    memcpy(tree + 1, values, sizeof(long long) * nblocks);
+    for (size_t i = 1; i <= nblocks; ++i) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= nblocks) tree[parent] += tree[i];
+    }
+}
+
+static inline size_t ai_block_len(const ai_index_t *ix, size_t b) {
+    return ix->n - b * AI_BLOCK < AI_BLOCK ? ix->n - b * AI_BLOCK : AI_BLOCK;
+}
+
+static inline void ai_free(ai_index_t *ix) {
+    free(ix->block_sum);
+    free(ix->block_even);
+    free(ix->tree_sum);
+    free(ix->tree_even);
+    free(ix->dirty);
+    memset(ix, 0, sizeof(*ix));
+}
+
+// Returns 0, or -1 if the index cannot be allocated. One full parallel pass.
+static inline int ai_build(ai_index_t *ix, int *a, size_t n) {
+    memset(ix, 0, sizeof(*ix));
+    ix->a = a;
+    ix->n = n;
+    ix->nblocks = (n + AI_BLOCK - 1) / AI_BLOCK;
+    const size_t nb = ix->nblocks ? ix->nblocks : 1;
+    ix->block_sum = (long long *)malloc(sizeof(long long) * nb);
+    ix->block_even = (long long *)malloc(sizeof(long long) * nb);
+    ix->tree_sum = (long long *)malloc(sizeof(long long) * (nb + 1));
+    ix->tree_even = (long long *)malloc(sizeof(long long) * (nb + 1));
+    ix->dirty = (unsigned char *)calloc(nb, 1);
+    if (!ix->block_sum || !ix->block_even || !ix->tree_sum || !ix->tree_even || !ix->dirty) {
+        ai_free(ix);
+        return -1;
+    }
+    ix->sum_kernel = sum_kernel_for(simd_isa_select());
+    ix->even_kernel = even_count_simd_for(simd_isa_select());
+
+    const long nblocks = (long)ix->nblocks;
+    #pragma omp parallel for schedule(static)
+    for (long b = 0; b < nblocks; ++b) {
+        const int *blk = a + (size_t)b * AI_BLOCK;
+        const size_t len = ai_block_len(ix, (size_t)b);
+        ix->block_sum[b] = ix->sum_kernel(blk, len);
+        ix->block_even[b] = ix->even_kernel(blk, len);
+    }
+    ai_tree_build(ix->tree_sum, ix->block_sum, ix->nblocks);
+    ai_tree_build(ix->tree_even, ix->block_even, ix->nblocks);
+    return 0;
+}
+
+static inline void ai_update(ai_index_t *ix, size_t i, int value) {
+    const size_t b = i / AI_BLOCK;
+    const int old = ix->a[i];
+    ix->a[i] = value;
+    if (ix->dirty[b]) return;   // ai_refresh() recomputes the whole block
+    const long long dsum = (long long)value - old;
+    const long long deven = (long long)((~value & 1) - (~old & 1));
+    ix->block_sum[b] += dsum;
+    ix->block_even[b] += deven;
+    if (dsum) ai_tree_add(ix->tree_sum, ix->nblocks, b, dsum);
+    if (deven) ai_tree_add(ix->tree_even, ix->nblocks, b, deven);
+}
+
+// Thread of an nthreads team whose static_range() of blocks holds block b.
+static inline int ai_block_owner(size_t nblocks, int nthreads, size_t b) {
+    const size_t q = nblocks / (size_t)nthreads, r = nblocks % (size_t)nthreads;
+    return b < r * (q + 1) ? (int)(b / (q + 1)) : (int)(r + (b - r * (q + 1)) / q);
+}
+
+static inline size_t ai_apply(ai_index_t *ix, size_t i, int value) {
+    ix->a[i] = value;
+    if (ix->dirty[i / AI_BLOCK]) return 0;
+    ix->dirty[i / AI_BLOCK] = 1;
+    return 1;
+}
+
+// Indices at or past n are ignored. The batch is bucketed by owning thread
+// with a counting sort (each thread counts and scatters its slice of the
+// batch), so every update is read twice and applied once instead of every
+// thread scanning the whole batch. Buckets keep batch order.
+static inline void ai_update_batch(ai_index_t *ix, const size_t *idx, const int *values, size_t count) {
+    const int max_threads = omp_get_max_threads();
+    const size_t mt = (size_t)max_threads;
+    size_t *order = (size_t *)malloc(sizeof(size_t) * (count ? count : 1));
+    size_t *offset = (size_t *)calloc(mt * mt + mt + 1, sizeof(size_t));
+    size_t newly_dirty = 0;
+    if (!order || !offset) {
+        // no room to bucket: apply serially
+        for (size_t k = 0; k < count; ++k) {
+            if (idx[k] < ix->n) newly_dirty += ai_apply(ix, idx[k], values[k]);
+        }
+        free(order);
+        free(offset);
+        ix->ndirty += newly_dirty;
+        return;
+    }
+
+    #pragma omp parallel num_threads(max_threads) reduction(+:newly_dirty)
+    {
+        const int nthreads = omp_get_num_threads(), tid = omp_get_thread_num();
+        const size_t nt = (size_t)nthreads;
+        size_t *mine = offset + (size_t)tid * nt;   // this slice's cursor per owner
+        size_t *bucket = offset + nt * nt;          // nt + 1 bucket bounds
+        size_t lo, hi;
+        static_range(count, tid, nthreads, &lo, &hi);
+        for (size_t k = lo; k < hi; ++k) {
+            if (idx[k] < ix->n) mine[ai_block_owner(ix->nblocks, nthreads, idx[k] / AI_BLOCK)]++;
+        }
+        #pragma omp barrier
+        #pragma omp single
+        {
+            // owner-major, then slice order: bucket o holds slice 0's updates
+            // for o, then slice 1's, ...
+            size_t pos = 0;
+            for (size_t o = 0; o < nt; ++o) {
+                bucket[o] = pos;
+                for (size_t src = 0; src < nt; ++src) {
+                    const size_t c = offset[src * nt + o];
+                    offset[src * nt + o] = pos;
+                    pos += c;
+                }
+            }
+            bucket[nt] = pos;
+        }
+        for (size_t k = lo; k < hi; ++k) {
+            if (idx[k] < ix->n) order[mine[ai_block_owner(ix->nblocks, nthreads, idx[k] / AI_BLOCK)]++] = k;
+        }
+        #pragma omp barrier
+        for (size_t j = bucket[tid]; j < bucket[tid + 1]; ++j) {
+            newly_dirty += ai_apply(ix, idx[order[j]], values[order[j]]);
+        }
+    }
+    free(order);
+    free(offset);
+    ix->ndirty += newly_dirty;
+}
+
+static inline void ai_refresh(ai_index_t *ix) {
+    if (ix->ndirty == 0) return;
+    size_t log_blocks = 1;
+    while (((size_t)1 << log_blocks) < ix->nblocks) log_blocks++;
+
+    // Few dirty blocks: recompute them and push the deltas into the trees
+    // (two tree walks per block). Tree nodes are shared between blocks, so
+    // this path is serial; it is only taken while those walks cost less
+    // than one rebuild
+    if (ix->ndirty * 2 * log_blocks <= ix->nblocks) {
+        for (size_t b = 0; b < ix->nblocks; ++b) {
+            if (!ix->dirty[b]) continue;
+            const int *blk = ix->a + b * AI_BLOCK;
+            const size_t len = ai_block_len(ix, b);
+            const long long s = ix->sum_kernel(blk, len), e = ix->even_kernel(blk, len);
+            ai_tree_add(ix->tree_sum, ix->nblocks, b, s - ix->block_sum[b]);
+            ai_tree_add(ix->tree_even, ix->nblocks, b, e - ix->block_even[b]);
+            ix->block_sum[b] = s;
+            ix->block_even[b] = e;
+            ix->dirty[b] = 0;
+        }
+        ix->ndirty = 0;
+        return;
+    }
+
+    // Many: recompute them in parallel and rebuild both trees in O(blocks)
+    const long nblocks = (long)ix->nblocks;
+    #pragma omp parallel for schedule(static)
+    for (long b = 0; b < nblocks; ++b) {
+        if (!ix->dirty[b]) continue;
+        const int *blk = ix->a + (size_t)b * AI_BLOCK;
+        const size_t len = ai_block_len(ix, (size_t)b);
+        ix->block_sum[b] = ix->sum_kernel(blk, len);
+        ix->block_even[b] = ix->even_kernel(blk, len);
+        ix->dirty[b] = 0;
+    }
+    ai_tree_build(ix->tree_sum, ix->block_sum, ix->nblocks);
+    ai_tree_build(ix->tree_even, ix->block_even, ix->nblocks);
+    ix->ndirty = 0;
+}
+
+// Shared shape of the range queries: trees for whole blocks, the kernel for
+// the partial blocks at the ends.
+static inline long long ai_range(ai_index_t *ix, size_t lo, size_t hi, int even) {
+    ai_refresh(ix);
+    if (hi > ix->n) hi = ix->n;
+    if (lo >= hi) return 0;
+    const long long *tree = even ? ix->tree_even : ix->tree_sum;
+    size_t first_full = (lo + AI_BLOCK - 1) / AI_BLOCK, end_full = hi / AI_BLOCK;
+    if (first_full >= end_full) {
+        return even ? ix->even_kernel(ix->a + lo, hi - lo) : ix->sum_kernel(ix->a + lo, hi - lo);
+    }
+    long long total = ai_tree_prefix(tree, end_full) - ai_tree_prefix(tree, first_full);
+    const size_t head = first_full * AI_BLOCK - lo, tail = hi - end_full * AI_BLOCK;
+    if (even) total += ix->even_kernel(ix->a + lo, head) + ix->even_kernel(ix->a + end_full * AI_BLOCK, tail);
+    else total += ix->sum_kernel(ix->a + lo, head) + ix->sum_kernel(ix->a + end_full * AI_BLOCK, tail);
+    return total;
+}
+
+static inline long long ai_range_sum(ai_index_t *ix, size_t lo, size_t hi) {
+    return ai_range(ix, lo, hi, 0);
+}
+
+static inline long long ai_range_even(ai_index_t *ix, size_t lo, size_t hi) {
+    return ai_range(ix, lo, hi, 1);
+}
+
+#endif
@@ -0,0 +1,304 @@
+#ifndef BATCH_EXEC_H
+#define BATCH_EXEC_H
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <omp.h>
+#include "bench_harness.h"
+#include "datagen.h"
+
+// Batch executor for many independent irregular jobs. A job is a range of
+// iterations of a per-iteration function; jobs arrive at a target rate in a
+// bounded FIFO and are run under one of three policies:
+//
+//   per-core    every thread pops a job and runs it alone: no fork/join per
+//               job and the best throughput, but a large job's latency is
+//               its whole serial time
+//   all-cores   one job at a time across the team (schedule(dynamic)): the
+//               shortest service time per job, but every job pays a
+//               fork/join and small ones queue behind large ones
+//   adaptive    one thread dispatches jobs as OpenMP tasks. A job of at
+//               least split_min iterations is split with taskloop over the
+//               idle workers when they outnumber the queued jobs; other
+//               jobs run as one task each. Once every worker is busy the
+//               dispatcher runs the job itself, so the bounded queue stays
+//               the only buffer
+//
+// The load generator is its own pthread and open-loop: Poisson arrivals at
+// cfg->rate. Latency runs from the scheduled arrival, so time the generator
+// spends blocked on a full queue is charged to the executor (no coordinated
+// omission).
+
+typedef double (*bx_iter_fn)(int iteration, void *ctx);
+
+typedef enum { BX_PER_CORE, BX_ALL_CORES, BX_ADAPTIVE, BX_POLICY_COUNT } bx_policy_t;
+
+typedef struct {
+    int id;
+    int first;
+    int count;
+    double arrival;   // set by the generator
+} bx_job_t;
+
+typedef struct {
+    bx_job_t *ring;
+    int capacity;
+    int head;
+    int size;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} bx_queue_t;
+
+typedef struct {
+    const bx_job_t *jobs;   // id = index, first, count
+    int njobs;
+    double rate;            // arrivals per second
+    int queue_capacity;
+    int split_min;          // adaptive: smallest job worth splitting
+    bx_iter_fn fn;
+    void *ctx;
+    uint64_t seed;
+} bx_config_t;
+
+typedef struct {
+    double seconds;      // first arrival slot to last completion
+    double throughput;   // jobs per second
+    double p50, p99, p999, max;
+    long full_waits;     // arrivals that found the queue full
+    long split_jobs;
+    double checksum;     // sum of job results in id order
+} bx_report_t;
+
+static inline const char *bx_policy_name(bx_policy_t p) {
+    switch (p) {
+    case BX_PER_CORE: return "per-core";
+    case BX_ALL_CORES: return "all-cores";
+    case BX_ADAPTIVE: return "adaptive";
+    default: return "?";
+    }
+}
+
+static inline int bx_queue_init(bx_queue_t *q, int capacity) {
+    memset(q, 0, sizeof(*q));
+    q->capacity = capacity > 0 ? capacity : 1;
+    q->ring = (bx_job_t *)malloc(sizeof(bx_job_t) * (size_t)q->capacity);
+    if (!q->ring) return -1;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    return 0;
+}
+
+static inline void bx_queue_free(bx_queue_t *q) {
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->ring);
+    q->ring = NULL;
+}
+
+// Blocks while the queue is full; returns 1 if it had to wait.
+static inline int bx_queue_push(bx_queue_t *q, const bx_job_t *job) {
+    int waited = 0;
+    pthread_mutex_lock(&q->lock);
+    while (q->size == q->capacity) {
+        waited = 1;
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    q->ring[(q->head + q->size) % q->capacity] = *job;
+    q->size++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+    return waited;
+}
+
+// Blocks while the queue is empty and open; returns 0 once it is closed
+// and drained.
+static inline int bx_queue_pop(bx_queue_t *q, bx_job_t *job) {
+    pthread_mutex_lock(&q->lock);
+    while (q->size == 0 && !q->closed) pthread_cond_wait(&q->not_empty, &q->lock);
+    if (q->size == 0) {
+        pthread_mutex_unlock(&q->lock);
+        return 0;
+    }
+    *job = q->ring[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->size--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return 1;
+}
+
+static inline int bx_queue_depth(bx_queue_t *q) {
+    pthread_mutex_lock(&q->lock);
+    int size = q->size;
+    pthread_mutex_unlock(&q->lock);
+    return size;
+}
+
+static inline void bx_queue_close(bx_queue_t *q) {
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+typedef struct {
+    const bx_config_t *cfg;
+    bx_queue_t queue;
+    double start;
+    double *arrival;   // per job id
+    double *done;
+    double *result;
+    long full_waits;
+    atomic_int busy;   // adaptive: workers running a job
+    atomic_long split_jobs;
+} bx_state_t;
+
+static inline void bx_sleep_until(double t) {
+    double wait = t - omp_get_wtime();
+    if (wait <= 0) return;
+    struct timespec ts = { (time_t)wait, (long)((wait - (double)(time_t)wait) * 1e9) };
+    nanosleep(&ts, NULL);
+}
+
+static void *bx_generator_main(void *raw) {
+    bx_state_t *st = (bx_state_t *)raw;
+    const bx_config_t *cfg = st->cfg;
+    double t = st->start;
+    for (int k = 0; k < cfg->njobs; ++k) {
+        double u = (double)(dg_random_u64(cfg->seed, (uint64_t)k) >> 11) * 0x1.0p-53;
+        t += -log(1.0 - u) / cfg->rate;
+        bx_sleep_until(t);
+        bx_job_t job = cfg->jobs[k];
+        job.id = k;
+        job.arrival = t;
+        st->arrival[k] = t;
+        st->full_waits += bx_queue_push(&st->queue, &job);
+    }
+    bx_queue_close(&st->queue);
+    return NULL;
+}
+
+static inline void bx_finish(bx_state_t *st, const bx_job_t *job, double result) {
+    st->result[job->id] = result;
+    st->done[job->id] = omp_get_wtime();
+}
+
+static inline void bx_run_serial(bx_state_t *st, const bx_job_t *job) {
+    double s = 0.0;
+    for (int i = 0; i < job->count; ++i) s += st->cfg->fn(job->first + i, st->cfg->ctx);
+    bx_finish(st, job, s);
+}
+
+static inline void bx_run_taskloop(bx_state_t *st, const bx_job_t *job, int parts) {
+    const bx_config_t *cfg = st->cfg;
+    double s = 0.0;
+    #pragma omp taskloop num_tasks(parts) reduction(+:s)
+    for (int i = 0; i < job->count; ++i) s += cfg->fn(job->first + i, cfg->ctx);
+    bx_finish(st, job, s);
+}
+
+static inline void bx_dispatch_adaptive(bx_state_t *st) {
+    #pragma omp parallel
+    #pragma omp single
+    {
+        const int workers = omp_get_num_threads() - 1;   // besides this dispatcher
+        bx_job_t job;
+        while (bx_queue_pop(&st->queue, &job)) {
+            const int busy = atomic_load_explicit(&st->busy, memory_order_acquire);
+            if (busy >= workers) {
+                bx_run_serial(st, &job);
+                continue;
+            }
+            const int idle = workers - busy;
+            const int parts = job.count >= st->cfg->split_min && idle > 1 && bx_queue_depth(&st->queue) < idle ? idle : 1;
+            if (parts > 1) atomic_fetch_add_explicit(&st->split_jobs, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&st->busy, parts, memory_order_acq_rel);
+            #pragma omp task firstprivate(job, parts)
+            {
+                if (parts > 1) bx_run_taskloop(st, &job, parts);
+                else bx_run_serial(st, &job);
+                atomic_fetch_sub_explicit(&st->busy, parts, memory_order_acq_rel);
+            }
+        }
+    }
+}
+
+// Returns 0, or -1 if the queue, the per-job records or the generator
+// thread cannot be created.
+static inline int bx_run(bx_policy_t policy, const bx_config_t *cfg, bx_report_t *out) {
+    bx_state_t st;
+    memset(&st, 0, sizeof(st));
+    st.cfg = cfg;
+    const size_t n = (size_t)(cfg->njobs > 0 ? cfg->njobs : 1);
+    st.arrival = (double *)calloc(n, sizeof(double));
+    st.done = (double *)calloc(n, sizeof(double));
+    st.result = (double *)calloc(n, sizeof(double));
+    if (!st.arrival || !st.done || !st.result || bx_queue_init(&st.queue, cfg->queue_capacity) != 0) {
+        free(st.arrival); free(st.done); free(st.result);
+        return -1;
+    }
+    atomic_init(&st.busy, 0);
+    atomic_init(&st.split_jobs, 0);
+
+    pthread_t generator;
+    st.start = omp_get_wtime();
+    if (pthread_create(&generator, NULL, bx_generator_main, &st) != 0) {
+        bx_queue_free(&st.queue);
+        free(st.arrival); free(st.done); free(st.result);
+        return -1;
+    }
+
+    bx_job_t job;
+    switch (policy) {
+    case BX_PER_CORE:
+        #pragma omp parallel private(job)
+        while (bx_queue_pop(&st.queue, &job)) bx_run_serial(&st, &job);
+        break;
+    case BX_ALL_CORES:
+        while (bx_queue_pop(&st.queue, &job)) {
+            double s = 0.0;
+            #pragma omp parallel for schedule(dynamic, 1) reduction(+:s)
+            for (int i = 0; i < job.count; ++i) s += cfg->fn(job.first + i, cfg->ctx);
+            bx_finish(&st, &job, s);
+        }
+        break;
+    default:
+        bx_dispatch_adaptive(&st);
+        break;
+    }
+    pthread_join(generator, NULL);
+
+    double last = st.start, checksum = 0.0;
+    for (int k = 0; k < cfg->njobs; ++k) {
+        if (st.done[k] > last) last = st.done[k];
+        checksum += st.result[k];
+        st.done[k] -= st.arrival[k];   // now the latency
+    }
+    qsort(st.done, n, sizeof(double), bench_cmp_double);
+    out->seconds = last - st.start;
+    out->throughput = out->seconds > 0 ? cfg->njobs / out->seconds : 0.0;
+    out->p50 = bench_percentile(st.done, cfg->njobs, 0.5);
+    out->p99 = bench_percentile(st.done, cfg->njobs, 0.99);
+    out->p999 = bench_percentile(st.done, cfg->njobs, 0.999);
+    out->max = cfg->njobs > 0 ? st.done[cfg->njobs - 1] : 0.0;
+    out->full_waits = st.full_waits;
+    out->split_jobs = atomic_load(&st.split_jobs);
+    out->checksum = checksum;
+
+    bx_queue_free(&st.queue);
+    free(st.arrival);
+    free(st.done);
+    free(st.result);
+    return 0;
+}
+
+#endif
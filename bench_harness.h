@@ -0,0 +1,161 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+// Benchmark harness: warmup runs, a repetition count calibrated to a time
+// budget, order statistics over all samples, and bootstrap confidence
+// intervals for ratios of medians (speedup) so comparisons between
+// configurations can be tested for significance instead of eyeballed.
+
+#ifndef BENCH_WARMUP
+#define BENCH_WARMUP 2
+#endif
+#ifndef BENCH_TARGET_SECONDS
+#define BENCH_TARGET_SECONDS 1.0   // measured time per configuration, excluding warmup
+#endif
+#ifndef BENCH_MIN_REPS
+#define BENCH_MIN_REPS 5
+#endif
+#ifndef BENCH_MAX_REPS
+#define BENCH_MAX_REPS 200
+#endif
+#ifndef BENCH_BOOTSTRAP
+#define BENCH_BOOTSTRAP 2000       // resamples per confidence interval
+#endif
+#define BENCH_CI_LEVEL 0.95
+
+// Once fn is inlined, a pass that only reads memory computes the same value
+// every rep and may be hoisted out of the timing loop. The clobber tells
+// the compiler memory may have changed after each call.
+#if defined(__GNUC__)
+#define BENCH_CLOBBER() __asm__ __volatile__("" ::: "memory")
+#else
+#define BENCH_CLOBBER() ((void)0)
+#endif
+
+typedef void (*bench_fn)(void *ctx);
+
+typedef struct {
+    double *times;
+    int reps;
+    int warmup;
+    double median;
+    double p5;
+    double p95;
+} bench_samples_t;
+
+typedef struct {
+    double estimate;
+    double lo;
+    double hi;
+} bench_ci_t;
+
+static inline int bench_cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Linear interpolation between closest ranks; `sorted` is ascending.
+static inline double bench_percentile(const double *sorted, int n, double p) {
+    if (n == 1) return sorted[0];
+    double pos = p * (n - 1);
+    int lo = (int)pos;
+    if (lo >= n - 1) return sorted[n - 1];
+    return sorted[lo] + (pos - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+static inline double bench_median_of(double *scratch, int n) {
+    qsort(scratch, (size_t)n, sizeof(double), bench_cmp_double);
+    return bench_percentile(scratch, n, 0.5);
+}
+
+// Warm up, calibrate from the warmup timings, then collect samples for
+// about target_seconds.
+static inline int bench_run_budget(bench_fn fn, void *ctx, double target_seconds, bench_samples_t *out) {
+    double warm_time = 0.0;
+    memset(out, 0, sizeof(*out));
+    for (int w = 0; w < BENCH_WARMUP || w == 0; ++w) {
+        double t0 = omp_get_wtime();
+        fn(ctx);
+        BENCH_CLOBBER();
+        warm_time = omp_get_wtime() - t0;   // last warmup is the most representative
+        out->warmup++;
+    }
+
+    int reps = warm_time > 0 ? (int)(target_seconds / warm_time) : BENCH_MAX_REPS;
+    if (reps < BENCH_MIN_REPS) reps = BENCH_MIN_REPS;
+    if (reps > BENCH_MAX_REPS) reps = BENCH_MAX_REPS;
+
+    out->times = (double *)malloc(sizeof(double) * (size_t)reps);
+    double *sorted = (double *)malloc(sizeof(double) * (size_t)reps);
+    if (!out->times || !sorted) { free(out->times); free(sorted); out->times = NULL; return -1; }
+    for (int r = 0; r < reps; ++r) {
+        double t0 = omp_get_wtime();
+        fn(ctx);
+        BENCH_CLOBBER();
+        out->times[r] = omp_get_wtime() - t0;
+    }
+    out->reps = reps;
+
+    memcpy(sorted, out->times, sizeof(double) * (size_t)reps);
+    qsort(sorted, (size_t)reps, sizeof(double), bench_cmp_double);
+    out->median = bench_percentile(sorted, reps, 0.5);
+    out->p5 = bench_percentile(sorted, reps, 0.05);
+    out->p95 = bench_percentile(sorted, reps, 0.95);
+    free(sorted);
+    return 0;
+}
+
+static inline int bench_run(bench_fn fn, void *ctx, bench_samples_t *out) {
+    return bench_run_budget(fn, ctx, BENCH_TARGET_SECONDS, out);
+}
+
+static inline void bench_free(bench_samples_t *s) {
+    free(s->times);
+    s->times = NULL;
+}
+
+static inline uint64_t bench_rng_next(uint64_t *state) {
+    // xorshift64*: fixed seed, so intervals are reproducible run to run
+    uint64_t x = *state;
+    x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Percentile bootstrap for median(num) / median(den): resample each sample
+// set with replacement, recompute the ratio, take the central
+// BENCH_CI_LEVEL interval of the resampled ratios.
+static inline bench_ci_t bench_ratio_ci(const bench_samples_t *num, const bench_samples_t *den) {
+    bench_ci_t ci = { num->median / den->median, 0.0, 0.0 };
+    int max_reps = num->reps > den->reps ? num->reps : den->reps;
+    double *scratch = (double *)malloc(sizeof(double) * (size_t)max_reps);
+    double *ratios = (double *)malloc(sizeof(double) * BENCH_BOOTSTRAP);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    if (!scratch || !ratios) {
+        free(scratch); free(ratios);
+        ci.lo = ci.hi = ci.estimate;
+        return ci;
+    }
+
+    for (int b = 0; b < BENCH_BOOTSTRAP; ++b) {
+        for (int k = 0; k < num->reps; ++k) scratch[k] = num->times[bench_rng_next(&state) % (uint64_t)num->reps];
+        double m_num = bench_median_of(scratch, num->reps);
+        for (int k = 0; k < den->reps; ++k) scratch[k] = den->times[bench_rng_next(&state) % (uint64_t)den->reps];
+        double m_den = bench_median_of(scratch, den->reps);
+        ratios[b] = m_num / m_den;
+    }
+    qsort(ratios, BENCH_BOOTSTRAP, sizeof(double), bench_cmp_double);
+    ci.lo = bench_percentile(ratios, BENCH_BOOTSTRAP, (1.0 - BENCH_CI_LEVEL) / 2);
+    ci.hi = bench_percentile(ratios, BENCH_BOOTSTRAP, 1.0 - (1.0 - BENCH_CI_LEVEL) / 2);
+    free(scratch);
+    free(ratios);
+    return ci;
+}
+
+#endif
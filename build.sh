@@ -24,7 +24,19 @@ case "$SRC" in
   *.cpp|*.cxx|*.cc|*.CPP|*.CXX|*.CC) CC="$LLVM_PREFIX/bin/clang++" ;;
 esac
 
-CFLAGS="-O3 -fopenmp -I$OMP_PREFIX/include"
+# Extra flags from the environment, e.g. EXTRA_CFLAGS=-DENABLE_TRACE
+CFLAGS="-O3 -fopenmp -I$OMP_PREFIX/include ${EXTRA_CFLAGS:-}"
+
+# MPI=1 builds through the MPI wrapper (hybrid mode of part4), still with
+# Homebrew clang underneath: brew install open-mpi
+if [ "${MPI:-0}" = "1" ]; then
+  export OMPI_CC="$CC" OMPI_CXX="$CC" MPICH_CC="$CC" MPICH_CXX="$CC"
+  case "$SRC" in
+    *.cpp|*.cxx|*.cc|*.CPP|*.CXX|*.CC) CC=mpicxx ;;
+    *) CC=mpicc ;;
+  esac
+  CFLAGS="$CFLAGS -DUSE_MPI"
+fi
 LDFLAGS="-L$OMP_PREFIX/lib -Wl,-rpath,$OMP_PREFIX/lib"
 
 echo "$CC $CFLAGS $SRC $LDFLAGS -o $OUT"
@@ -0,0 +1,326 @@
+#ifndef COMPACT_COLUMN_H
+#define COMPACT_COLUMN_H
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "simd_sum.h"
+
+// Compact column storage for int32 data with a narrow value range. Values
+// are stored as unsigned offsets from a base (the minimum) in one of three
+// layouts:
+//
+//   u16      one uint16_t per value; range below 2^16
+//   packed   32 / w values per uint32_t word, w = 4, 8, 10, 16 or 32 bits.
+//            Slots never straddle words, so 10-bit data packs 3 values per
+//            word (2 bits unused) and decodes with one shift and mask each
+//   for      frame of reference: CC_FOR_BLOCK-value blocks, each packed with
+//            its own base and width, for data whose local range is much
+//            narrower than the global one (periodic, sorted, clustered)
+//
+// Sum and even count run on the encoded form: each SIMD lane holds one
+// word, shifts and masks its slots out in registers and accumulates them,
+// so the int array is never rebuilt. The base is folded in at the end:
+// sum = count * base + sum(offsets), and an odd base flips every parity.
+// The column is read-only; re-encode after the source array changes.
+
+#define CC_FOR_BLOCK 192   // a multiple of every slots-per-word count (8, 4, 3, 2, 1)
+#define CC_NWIDTHS 5
+
+typedef enum { CC_AUTO, CC_U16, CC_PACKED, CC_FOR } cc_encoding_t;
+
+typedef struct {
+    int32_t base;
+    uint32_t word;     // first word of the block in cc_column_t.words
+    uint8_t width;
+} cc_block_t;
+
+typedef struct {
+    cc_encoding_t encoding;
+    size_t n;
+    int32_t base;          // u16, packed
+    int width;             // packed
+    uint16_t *u16;
+    uint32_t *words;       // packed, for
+    size_t nwords;
+    cc_block_t *blocks;    // for
+    size_t nblocks;
+} cc_column_t;
+
+static inline const char *cc_encoding_name(cc_encoding_t e) {
+    switch (e) {
+    case CC_U16: return "u16";
+    case CC_PACKED: return "packed";
+    case CC_FOR: return "for";
+    default: return "auto";
+    }
+}
+
+// Slot width for a range of offsets: the smallest of 4, 8, 10, 16, 32 bits
+// that holds it. A width between these would not fit more slots per word.
+static inline int cc_round_width(uint32_t range) {
+    const int bits = range ? 32 - __builtin_clz(range) : 0;
+    return bits <= 4 ? 4 : bits <= 8 ? 8 : bits <= 10 ? 10 : bits <= 16 ? 16 : 32;
+}
+
+static inline int cc_width_index(int width) {
+    return width == 4 ? 0 : width == 8 ? 1 : width == 10 ? 2 : width == 16 ? 3 : 4;
+}
+
+static inline size_t cc_words_for(size_t count, int width) {
+    const size_t slots = (size_t)(32 / width);
+    return (count + slots - 1) / slots;
+}
+
+// Stored bytes, FOR block headers included.
+static inline size_t cc_bytes(const cc_column_t *c) {
+    if (c->encoding == CC_U16) return c->n * sizeof(uint16_t);
+    return c->nwords * sizeof(uint32_t) + c->nblocks * sizeof(cc_block_t);
+}
+
+typedef unsigned long long (*cc_words_fn)(const uint32_t *w, size_t count);
+typedef unsigned long long (*cc_u16_fn)(const uint16_t *v, size_t count);
+
+// Sum / odd count of the offsets in `count` words of width-B slots. The
+// slot loop has a constant trip count, so it unrolls and the word loop
+// vectorizes; trailing slots of a partial word hold 0 and add nothing.
+#define CC_DEFINE_WIDTH_KERNELS(suffix, ATTR, B)                                                \
+ATTR static unsigned long long cc_sum_w##B##_##suffix(const uint32_t *w, size_t count) {      \
+    unsigned long long s = 0;                                                                 \
+    _Pragma("omp simd reduction(+:s)")                                                        \
+    for (size_t i = 0; i < count; ++i) {                                                      \
+        uint32_t x = w[i], t = 0;                                                             \
+        for (int j = 0; j < 32 / B; ++j) t += (x >> (j * B)) & (uint32_t)((1ull << B) - 1);  \
+        s += t;                                                                               \
+    }                                                                                         \
+    return s;                                                                                 \
+}                                                                                             \
+ATTR static unsigned long long cc_odd_w##B##_##suffix(const uint32_t *w, size_t count) {      \
+    unsigned long long c = 0;                                                                 \
+    _Pragma("omp simd reduction(+:c)")                                                        \
+    for (size_t i = 0; i < count; ++i) {                                                      \
+        uint32_t x = w[i], t = 0;                                                             \
+        for (int j = 0; j < 32 / B; ++j) t += (x >> (j * B)) & 1u;                            \
+        c += t;                                                                               \
+    }                                                                                         \
+    return c;                                                                                 \
+}
+
+#define CC_DEFINE_KERNELS(suffix, ATTR)                                                         \
+CC_DEFINE_WIDTH_KERNELS(suffix, ATTR, 4)                                                        \
+CC_DEFINE_WIDTH_KERNELS(suffix, ATTR, 8)                                                        \
+CC_DEFINE_WIDTH_KERNELS(suffix, ATTR, 10)                                                       \
+CC_DEFINE_WIDTH_KERNELS(suffix, ATTR, 16)                                                       \
+CC_DEFINE_WIDTH_KERNELS(suffix, ATTR, 32)                                                       \
+ATTR static unsigned long long cc_sum_u16_##suffix(const uint16_t *v, size_t count) {          \
+    unsigned long long s = 0;                                                                 \
+    _Pragma("omp simd reduction(+:s)")                                                        \
+    for (size_t i = 0; i < count; ++i) s += v[i];                                             \
+    return s;                                                                                 \
+}                                                                                             \
+ATTR static unsigned long long cc_odd_u16_##suffix(const uint16_t *v, size_t count) {          \
+    unsigned long long c = 0;                                                                 \
+    _Pragma("omp simd reduction(+:c)")                                                        \
+    for (size_t i = 0; i < count; ++i) c += v[i] & 1u;                                        \
+    return c;                                                                                 \
+}
+
+typedef struct {
+    cc_u16_fn sum_u16;
+    cc_u16_fn odd_u16;
+    cc_words_fn sum[CC_NWIDTHS];   // by cc_width_index()
+    cc_words_fn odd[CC_NWIDTHS];
+} cc_kernels_t;
+
+#define CC_KERNEL_SET(suffix)                                                                   \
+    { cc_sum_u16_##suffix, cc_odd_u16_##suffix,                                               \
+      { cc_sum_w4_##suffix, cc_sum_w8_##suffix, cc_sum_w10_##suffix, cc_sum_w16_##suffix,     \
+        cc_sum_w32_##suffix },                                                                \
+      { cc_odd_w4_##suffix, cc_odd_w8_##suffix, cc_odd_w10_##suffix, cc_odd_w16_##suffix,     \
+        cc_odd_w32_##suffix } }
+
+CC_DEFINE_KERNELS(default, )
+#if defined(__x86_64__) || defined(__i386__)
+CC_DEFINE_KERNELS(avx2, SIMD_TARGET("avx2"))
+CC_DEFINE_KERNELS(avx512, SIMD_TARGET("avx512f,avx512bw"))
+#endif
+
+static inline const cc_kernels_t *cc_select_kernels(void) {
+    static const cc_kernels_t generic = CC_KERNEL_SET(default);
+#if defined(__x86_64__) || defined(__i386__)
+    static const cc_kernels_t avx2 = CC_KERNEL_SET(avx2);
+    static const cc_kernels_t avx512 = CC_KERNEL_SET(avx512);
+    simd_isa_t isa = simd_isa_select();
+    if (isa == ISA_AVX512 && __builtin_cpu_supports("avx512bw")) return &avx512;
+    if (isa >= ISA_AVX2) return &avx2;
+#endif
+    return &generic;
+}
+
+// Packs the offsets a[i] - base of `count` values into words; the unused
+// slots of the last word stay 0.
+static inline void cc_pack(uint32_t *words, const int *a, size_t count, int32_t base, int width) {
+    const size_t slots = (size_t)(32 / width);
+    for (size_t w = 0, i = 0; i < count; ++w) {
+        uint32_t x = 0;
+        for (size_t j = 0; j < slots && i < count; ++j, ++i) x |= ((uint32_t)a[i] - (uint32_t)base) << (j * width);
+        words[w] = x;
+    }
+}
+
+static inline size_t cc_block_count(size_t n, size_t b) {
+    return n - b * CC_FOR_BLOCK < CC_FOR_BLOCK ? n - b * CC_FOR_BLOCK : CC_FOR_BLOCK;
+}
+
+static inline void cc_free(cc_column_t *c) {
+    free(c->u16);
+    free(c->words);
+    free(c->blocks);
+    c->u16 = NULL;
+    c->words = NULL;
+    c->blocks = NULL;
+}
+
+// Returns 0, or -1 if the storage cannot be allocated. CC_AUTO picks the
+// layout with the fewest bytes (u16, then packed on a tie); CC_U16 on a
+// range of 2^16 or more falls back to CC_PACKED. Written with the static
+// partition the queries use (first touch).
+static inline int cc_encode(cc_column_t *c, const int *a, size_t n, cc_encoding_t encoding) {
+    memset(c, 0, sizeof(*c));
+    c->n = n;
+    int mn = INT_MAX, mx = INT_MIN;
+    #pragma omp parallel for simd schedule(static) reduction(min:mn) reduction(max:mx)
+    for (size_t i = 0; i < n; ++i) {
+        mn = a[i] < mn ? a[i] : mn;
+        mx = a[i] > mx ? a[i] : mx;
+    }
+    if (n == 0) mn = mx = 0;
+    c->base = mn;
+    c->width = cc_round_width((uint32_t)mx - (uint32_t)mn);
+
+    // FOR block bases and widths; CC_AUTO needs them for the FOR size
+    const size_t nblocks = (n + CC_FOR_BLOCK - 1) / CC_FOR_BLOCK;
+    cc_block_t *blocks = NULL;
+    size_t for_words = 0;
+    if (encoding == CC_AUTO || encoding == CC_FOR) {
+        blocks = (cc_block_t *)malloc(sizeof(cc_block_t) * (nblocks ? nblocks : 1));
+        if (!blocks) return -1;
+        #pragma omp parallel for schedule(static)
+        for (size_t b = 0; b < nblocks; ++b) {
+            const int *blk = a + b * CC_FOR_BLOCK;
+            const size_t count = cc_block_count(n, b);
+            int lo = blk[0], hi = blk[0];
+            for (size_t i = 1; i < count; ++i) {
+                lo = blk[i] < lo ? blk[i] : lo;
+                hi = blk[i] > hi ? blk[i] : hi;
+            }
+            blocks[b].base = lo;
+            blocks[b].width = (uint8_t)cc_round_width((uint32_t)hi - (uint32_t)lo);
+        }
+        for (size_t b = 0; b < nblocks; ++b) {
+            blocks[b].word = (uint32_t)for_words;
+            for_words += cc_words_for(cc_block_count(n, b), blocks[b].width);
+        }
+    }
+
+    if (encoding == CC_AUTO) {
+        const size_t u16_bytes = c->width <= 16 ? n * sizeof(uint16_t) : SIZE_MAX;
+        const size_t packed_bytes = cc_words_for(n, c->width) * sizeof(uint32_t);
+        const size_t for_bytes = for_words * sizeof(uint32_t) + nblocks * sizeof(cc_block_t);
+        encoding = u16_bytes <= packed_bytes && u16_bytes <= for_bytes ? CC_U16
+                 : packed_bytes <= for_bytes ? CC_PACKED : CC_FOR;
+    }
+    if (encoding == CC_U16 && c->width > 16) encoding = CC_PACKED;
+    c->encoding = encoding;
+    if (encoding != CC_FOR) {
+        free(blocks);
+        blocks = NULL;
+    }
+
+    if (encoding == CC_U16) {
+        c->u16 = (uint16_t *)malloc(sizeof(uint16_t) * (n ? n : 1));
+        if (!c->u16) return -1;
+        uint16_t *out = c->u16;
+        const uint32_t base = (uint32_t)mn;
+        #pragma omp parallel for simd schedule(static)
+        for (size_t i = 0; i < n; ++i) out[i] = (uint16_t)((uint32_t)a[i] - base);
+    } else if (encoding == CC_PACKED) {
+        const size_t slots = (size_t)(32 / c->width);
+        c->nwords = cc_words_for(n, c->width);
+        c->words = (uint32_t *)malloc(sizeof(uint32_t) * (c->nwords ? c->nwords : 1));
+        if (!c->words) return -1;
+        #pragma omp parallel
+        {
+            size_t lo, hi;
+            static_range(c->nwords, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+            if (hi > lo) {
+                const size_t first = lo * slots, last = hi * slots < n ? hi * slots : n;
+                cc_pack(c->words + lo, a + first, last - first, c->base, c->width);
+            }
+        }
+    } else {
+        c->blocks = blocks;
+        c->nblocks = nblocks;
+        c->nwords = for_words;
+        c->words = (uint32_t *)malloc(sizeof(uint32_t) * (for_words ? for_words : 1));
+        if (!c->words) return -1;
+        #pragma omp parallel
+        {
+            size_t lo, hi;
+            static_range(nblocks, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+            for (size_t b = lo; b < hi; ++b) {
+                cc_pack(c->words + blocks[b].word, a + b * CC_FOR_BLOCK, cc_block_count(n, b), blocks[b].base,
+                        blocks[b].width);
+            }
+        }
+    }
+    return 0;
+}
+
+// Parallel scan of the offsets: their sum, or the number of odd values.
+static inline long long cc_scan(const cc_column_t *c, int count_odd) {
+    const cc_kernels_t *k = cc_select_kernels();
+    long long total = 0;
+    #pragma omp parallel reduction(+:total)
+    {
+        const int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        size_t lo, hi;
+        if (c->encoding == CC_U16) {
+            static_range(c->n, tid, nthreads, &lo, &hi);
+            total += (long long)(count_odd ? k->odd_u16 : k->sum_u16)(c->u16 + lo, hi - lo);
+        } else if (c->encoding == CC_PACKED) {
+            const int wi = cc_width_index(c->width);
+            static_range(c->nwords, tid, nthreads, &lo, &hi);
+            total += (long long)(count_odd ? k->odd[wi] : k->sum[wi])(c->words + lo, hi - lo);
+        } else {
+            static_range(c->nblocks, tid, nthreads, &lo, &hi);
+            for (size_t b = lo; b < hi; ++b) {
+                const cc_block_t *blk = &c->blocks[b];
+                const long long count = (long long)cc_block_count(c->n, b);
+                const int wi = cc_width_index(blk->width);
+                const size_t words = cc_words_for((size_t)count, blk->width);
+                if (count_odd) {
+                    long long odd = (long long)k->odd[wi](c->words + blk->word, words);
+                    total += (blk->base & 1) ? count - odd : odd;
+                } else {
+                    total += (long long)blk->base * count + (long long)k->sum[wi](c->words + blk->word, words);
+                }
+            }
+        }
+    }
+    if (c->encoding == CC_FOR) return total;
+    if (count_odd) return (c->base & 1) ? (long long)c->n - total : total;
+    return total + (long long)c->base * (long long)c->n;
+}
+
+static inline long long cc_sum(const cc_column_t *c) {
+    return cc_scan(c, 0);
+}
+
+static inline long long cc_count_even(const cc_column_t *c) {
+    return (long long)c->n - cc_scan(c, 1);
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef DATAGEN_H
+#define DATAGEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <omp.h>
+#include "simd_sum.h"
+
+// Parallel data generation. Every fill splits the array with static_range()
+// (the partition of schedule(static)), so it also serves as the NUMA first
+// touch, and each thread's inner loop is a branch-free `omp simd` loop.
+//
+// Random values come from a counter-based generator: element i is the
+// SplitMix64 output for counter i, i.e. mix(seed + (i + 1) * golden).
+// That is the i-th value of an ordinary sequential SplitMix64 stream, but
+// any element can be computed on its own, so the contents depend only on
+// the seed and never on the thread count or the partition.
+
+#define DG_GOLDEN 0x9E3779B97F4A7C15ULL
+#ifndef DG_DEFAULT_SEED
+#define DG_DEFAULT_SEED 1
+#endif
+
+static inline uint64_t dg_mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t dg_random_u64(uint64_t seed, uint64_t index) {
+    return dg_mix64(seed + (index + 1) * DG_GOLDEN);
+}
+
+// Uniform in [0, range) by multiply-shift on the top 32 bits (Lemire); the
+// bias is below range / 2^32.
+static inline uint32_t dg_random_below(uint64_t seed, uint64_t index, uint32_t range) {
+    return (uint32_t)(((dg_random_u64(seed, index) >> 32) * (uint64_t)range) >> 32);
+}
+
+// Same for ranges past 2^32: the high half of the 128-bit product.
+static inline uint64_t dg_random_below64(uint64_t seed, uint64_t index, uint64_t range) {
+    const uint64_t x = dg_random_u64(seed, index);
+#if defined(__SIZEOF_INT128__)
+    return (uint64_t)(((unsigned __int128)x * range) >> 64);
+#else
+    const uint64_t xl = x & 0xFFFFFFFFu, xh = x >> 32, rl = range & 0xFFFFFFFFu, rh = range >> 32;
+    const uint64_t mid = (xl * rl >> 32) + (xh * rl & 0xFFFFFFFFu) + (xl * rh & 0xFFFFFFFFu);
+    return xh * rh + (xh * rl >> 32) + (xl * rh >> 32) + (mid >> 32);
+#endif
+}
+
+// Skewed towards 0: range * u^skew for u uniform in [0, 1) and skew in
+// 1..4 (larger values act as 4). skew = 1 is uniform; larger values pile up
+// at the low end (skew 3: half the values fall below range / 8). The
+// unrolled powers keep the element loop vectorizable.
+static inline uint32_t dg_random_skewed(uint64_t seed, uint64_t index, uint32_t range, int skew) {
+    double u = (double)(dg_random_u64(seed, index) >> 11) * (1.0 / 9007199254740992.0);
+    double p = u;
+    if (skew > 1) p *= u;
+    if (skew > 2) p *= u;
+    if (skew > 3) p *= u;
+    return (uint32_t)(p * range);
+}
+
+// DATA_SEED from the environment, or DG_DEFAULT_SEED.
+static inline uint64_t dg_seed_from_env(void) {
+    const char *env = getenv("DATA_SEED");
+    return env && *env ? strtoull(env, NULL, 0) : DG_DEFAULT_SEED;
+}
+
+// a[i] = start + i
+static inline void dg_fill_ramp(int *a, size_t n, int start) {
+    #pragma omp parallel
+    {
+        size_t lo, hi;
+        static_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+        #pragma omp simd
+        for (size_t i = lo; i < hi; ++i) a[i] = start + (int)i;
+    }
+}
+
+// a[i] = (first + i) % modulus, without a division per element: each
+// thread divides once for its first element, then writes ramps
+// 0..modulus-1. `first` lets a slice of a larger array match the whole.
+static inline void dg_fill_mod(int *a, size_t n, int modulus, size_t first) {
+    #pragma omp parallel
+    {
+        size_t lo, hi;
+        static_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+        int v = (int)((first + lo) % (size_t)modulus);
+        for (size_t i = lo; i < hi; v = 0) {
+            size_t run = (size_t)(modulus - v) < hi - i ? (size_t)(modulus - v) : hi - i;
+            int *dst = a + i;
+            #pragma omp simd
+            for (size_t k = 0; k < run; ++k) dst[k] = v + (int)k;
+            i += run;
+        }
+    }
+}
+
+// Per-thread random fill kernels, compiled once per ISA. The 64-bit
+// multiplies of the mixer only vectorize well with AVX-512DQ (vpmullq);
+// AVX2 still gets 4-wide emulated multiplies instead of SSE2's 2-wide.
+#define DG_DEFINE_RANDOM_KERNELS(suffix, ATTR)                                                            \
+ATTR static void dg_uniform_block_##suffix(int *a, size_t lo, size_t hi, uint32_t range, uint64_t seed) { \
+    _Pragma("omp simd")                                                                                 \
+    for (size_t i = lo; i < hi; ++i) a[i] = (int)dg_random_below(seed, i, range);                       \
+}                                                                                                       \
+ATTR static void dg_skewed_block_##suffix(int *a, size_t lo, size_t hi, uint32_t range, int skew,      \
+                                          uint64_t seed) {                                              \
+    _Pragma("omp simd")                                                                                 \
+    for (size_t i = lo; i < hi; ++i) a[i] = (int)dg_random_skewed(seed, i, range, skew);                \
+}
+
+typedef void (*dg_uniform_fn)(int *a, size_t lo, size_t hi, uint32_t range, uint64_t seed);
+typedef void (*dg_skewed_fn)(int *a, size_t lo, size_t hi, uint32_t range, int skew, uint64_t seed);
+
+DG_DEFINE_RANDOM_KERNELS(default, )
+#if defined(__x86_64__) || defined(__i386__)
+DG_DEFINE_RANDOM_KERNELS(avx2, SIMD_TARGET("avx2"))
+DG_DEFINE_RANDOM_KERNELS(avx512, SIMD_TARGET("avx512f,avx512dq"))
+#endif
+
+// Returns the ISA name used, for the setup report.
+static inline const char *dg_select_kernels(dg_uniform_fn *uniform, dg_skewed_fn *skewed) {
+    *uniform = dg_uniform_block_default;
+    *skewed = dg_skewed_block_default;
+#if defined(__x86_64__) || defined(__i386__)
+    simd_isa_t isa = simd_isa_select();
+    if (isa == ISA_AVX512 && __builtin_cpu_supports("avx512dq")) {
+        *uniform = dg_uniform_block_avx512;
+        *skewed = dg_skewed_block_avx512;
+        return "avx512";
+    }
+    if (isa >= ISA_AVX2) {
+        *uniform = dg_uniform_block_avx2;
+        *skewed = dg_skewed_block_avx2;
+        return "avx2";
+    }
+#endif
+    return "default";
+}
+
+// a[i] uniform in [0, range)
+static inline void dg_fill_uniform(int *a, size_t n, uint32_t range, uint64_t seed) {
+    dg_uniform_fn uniform;
+    dg_skewed_fn skewed;
+    dg_select_kernels(&uniform, &skewed);
+    #pragma omp parallel
+    {
+        size_t lo, hi;
+        static_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+        uniform(a, lo, hi, range, seed);
+    }
+}
+
+// a[i] in [0, range), skewed towards 0 (see dg_random_skewed)
+static inline void dg_fill_skewed(int *a, size_t n, uint32_t range, int skew, uint64_t seed) {
+    dg_uniform_fn uniform;
+    dg_skewed_fn skewed;
+    dg_select_kernels(&uniform, &skewed);
+    #pragma omp parallel
+    {
+        size_t lo, hi;
+        static_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+        skewed(a, lo, hi, range, skew, seed);
+    }
+}
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef DATASET_IO_H
+#define DATASET_IO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <omp.h>
+
+// On-disk dataset: a fixed 24-byte header followed by `count` packed
+// little-endian integers of `elem_size` bytes (4 = int32, 8 = int64). The
+// payload starts 8-byte aligned so a mapping can be used as an array directly.
+//
+// Two ways to consume one:
+//   dataset_map()    mmap the whole file (MADV_SEQUENTIAL); the kernels run on
+//                    the mapping as if it were a malloc'd array
+//   dataset_stream() read fixed-size blocks into two buffers; a reader thread
+//                    fills one while the OpenMP team reduces the other, so
+//                    files larger than RAM work and I/O overlaps compute
+
+#define DATASET_MAGIC "PCLBDATA"
+#define DATASET_VERSION 1
+#ifndef DATASET_CHUNK_ELEMS
+#define DATASET_CHUNK_ELEMS (8u * 1024 * 1024)   // 32 MB per int32 block
+#endif
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t elem_size;
+    uint64_t count;
+} dataset_header_t;
+
+typedef struct {
+    dataset_header_t header;
+    void *map;
+    size_t map_bytes;
+    const void *data;    // first payload element
+} dataset_t;
+
+typedef struct {
+    double wall_time;
+    double compute_time;   // time spent inside the block callback
+    double read_time;      // time spent in pread, on whichever thread
+    size_t blocks;
+    uint64_t bytes;
+} dataset_stream_stats_t;
+
+typedef void (*dataset_block_fn)(const void *block, size_t count, uint32_t elem_size, void *ctx);
+
+static inline int dataset_read_header(int fd, const char *path, dataset_header_t *hdr) {
+    if (pread(fd, hdr, sizeof(*hdr), 0) != (ssize_t)sizeof(*hdr)) {
+        fprintf(stderr, "%s: too short for a dataset header\n", path);
+        return -1;
+    }
+    if (memcmp(hdr->magic, DATASET_MAGIC, sizeof(hdr->magic)) != 0 || hdr->version != DATASET_VERSION) {
+        fprintf(stderr, "%s: not a version %d dataset file\n", path, DATASET_VERSION);
+        return -1;
+    }
+    if (hdr->elem_size != 4 && hdr->elem_size != 8) {
+        fprintf(stderr, "%s: unsupported element size %u\n", path, hdr->elem_size);
+        return -1;
+    }
+    if (hdr->count > (UINT64_MAX - sizeof(*hdr)) / hdr->elem_size) {
+        fprintf(stderr, "%s: element count %llu overflows the file size\n", path, (unsigned long long)hdr->count);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(*hdr) + hdr->count * hdr->elem_size) {
+        fprintf(stderr, "%s: payload shorter than the %llu elements in the header\n",
+                path, (unsigned long long)hdr->count);
+        return -1;
+    }
+    return 0;
+}
+
+static inline void dataset_advise_sequential(int fd) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+    (void)fd;
+#endif
+}
+
+static inline int dataset_map(const char *path, dataset_t *ds) {
+    memset(ds, 0, sizeof(*ds));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { perror(path); return -1; }
+    if (dataset_read_header(fd, path, &ds->header) != 0) { close(fd); return -1; }
+
+    const uint64_t bytes = sizeof(dataset_header_t) + ds->header.count * ds->header.elem_size;
+    if (bytes > SIZE_MAX) {
+        fprintf(stderr, "%s: too large to map in this address space\n", path);
+        close(fd);
+        return -1;
+    }
+    dataset_advise_sequential(fd);
+    ds->map_bytes = (size_t)bytes;
+    ds->map = mmap(NULL, ds->map_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ds->map == MAP_FAILED) { perror("mmap"); ds->map = NULL; return -1; }
+    madvise(ds->map, ds->map_bytes, MADV_SEQUENTIAL);
+    ds->data = (const char *)ds->map + sizeof(dataset_header_t);
+    return 0;
+}
+
+static inline void dataset_unmap(dataset_t *ds) {
+    if (ds->map) munmap(ds->map, ds->map_bytes);
+    ds->map = NULL;
+    ds->data = NULL;
+}
+
+typedef struct {
+    int fd;
+    void *buffer;
+    off_t offset;
+    size_t bytes;
+    ssize_t result;
+    double seconds;
+} dataset_read_job_t;
+
+static inline void *dataset_read_block(void *arg) {
+    dataset_read_job_t *job = (dataset_read_job_t *)arg;
+    double t0 = omp_get_wtime();
+    size_t done = 0;
+    while (done < job->bytes) {
+        ssize_t r = pread(job->fd, (char *)job->buffer + done, job->bytes - done, job->offset + (off_t)done);
+        if (r <= 0) { job->result = -1; return NULL; }
+        done += (size_t)r;
+    }
+    job->result = (ssize_t)done;
+    job->seconds = omp_get_wtime() - t0;
+    return NULL;
+}
+
+// Stream the payload through `fn` in blocks of `chunk_elems`. Block k+1 is
+// read on a helper thread while the calling thread (and its OpenMP team,
+// inside `fn`) processes block k. Returns 0 on success.
+static inline int dataset_stream(const char *path, size_t chunk_elems, dataset_block_fn fn, void *ctx,
+                                 dataset_header_t *hdr_out, dataset_stream_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { perror(path); return -1; }
+    dataset_header_t hdr;
+    if (dataset_read_header(fd, path, &hdr) != 0) { close(fd); return -1; }
+    if (hdr_out) *hdr_out = hdr;
+    dataset_advise_sequential(fd);
+
+    size_t block_bytes = chunk_elems * hdr.elem_size;
+    void *buffers[2] = { malloc(block_bytes), malloc(block_bytes) };
+    if (!buffers[0] || !buffers[1]) {
+        free(buffers[0]); free(buffers[1]); close(fd);
+        fprintf(stderr, "Memory allocation failed!\n");
+        return -1;
+    }
+
+    double wall_start = omp_get_wtime();
+    uint64_t remaining = hdr.count;
+    off_t offset = (off_t)sizeof(dataset_header_t);
+    int status = 0;
+
+    // First block has nothing to overlap with
+    dataset_read_job_t job = { fd, buffers[0], offset, 0, 0, 0.0 };
+    size_t cur_count = remaining < chunk_elems ? (size_t)remaining : chunk_elems;
+    job.bytes = cur_count * hdr.elem_size;
+    dataset_read_block(&job);
+    if (job.result < 0) status = -1;
+    stats->read_time += job.seconds;
+    offset += (off_t)job.bytes;
+    remaining -= cur_count;
+
+    for (int cur = 0; status == 0 && cur_count > 0; cur ^= 1) {
+        size_t next_count = remaining < chunk_elems ? (size_t)remaining : chunk_elems;
+        dataset_read_job_t next = { fd, buffers[cur ^ 1], offset, next_count * hdr.elem_size, 0, 0.0 };
+        pthread_t reader;
+        int reading = next_count > 0 && pthread_create(&reader, NULL, dataset_read_block, &next) == 0;
+        if (next_count > 0 && !reading) dataset_read_block(&next);   // no thread: read inline
+
+        double t0 = omp_get_wtime();
+        fn(buffers[cur], cur_count, hdr.elem_size, ctx);
+        stats->compute_time += omp_get_wtime() - t0;
+        stats->blocks++;
+        stats->bytes += (uint64_t)cur_count * hdr.elem_size;
+
+        if (reading) pthread_join(reader, NULL);
+        if (next_count > 0) {
+            if (next.result < 0) status = -1;
+            stats->read_time += next.seconds;
+        }
+        offset += (off_t)next.bytes;
+        remaining -= next_count;
+        cur_count = next_count;
+    }
+
+    stats->wall_time = omp_get_wtime() - wall_start;
+    if (status != 0) fprintf(stderr, "%s: read error while streaming\n", path);
+    free(buffers[0]);
+    free(buffers[1]);
+    close(fd);
+    return status;
+}
+
+// Compute time over wall time: 1.0 means reads were completely hidden
+// behind the reductions.
+static inline void dataset_stream_report(const dataset_stream_stats_t *stats) {
+    printf("Blocks: %zu, bytes: %llu\n", stats->blocks, (unsigned long long)stats->bytes);
+    printf("Wall time: %f seconds (%.2f GB/s)\n", stats->wall_time, stats->bytes / stats->wall_time / 1e9);
+    printf("Compute time: %f seconds, read time: %f seconds\n", stats->compute_time, stats->read_time);
+    printf("Overlap efficiency (compute / wall): %.2f%%\n", stats->compute_time / stats->wall_time * 100);
+}
+
+#endif
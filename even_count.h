@@ -0,0 +1,225 @@
+#ifndef EVEN_COUNT_H
+#define EVEN_COUNT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <omp.h>
+#include "simd_isa.h"
+#include "simd_sum.h"
+
+// Even-counting engine. All variants test the low bit instead of `% 2`:
+// in two's complement the low bit is the parity for negative values as well,
+// and it needs neither a signed division fix-up nor a data-dependent branch.
+// Kernels count odd elements (low bit set) and return n - odd.
+//
+//   branchy      the original `a[i] % 2 == 0` loop, kept as the reference
+//   branchfree   scalar `~a[i] & 1` accumulated into four counters
+//   simd         low bit -> mask, movemask/popcount or per-lane vector adds
+//   sidecar      bit-packed parity (1 bit per element), popcount over words
+
+// Iterations per vector accumulator between flushes to 64 bits.
+#define EC_FLUSH_ITERS ((size_t)1 << 28)
+
+typedef long long (*even_count_fn)(const int *a, size_t n);
+
+static inline long long even_count_branchy(const int *a, size_t n) {
+    long long count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (a[i] % 2 == 0) count++;
+    }
+    return count;
+}
+
+static inline long long even_count_branchfree(const int *a, size_t n) {
+    long long c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c0 += ~a[i] & 1;
+        c1 += ~a[i + 1] & 1;
+        c2 += ~a[i + 2] & 1;
+        c3 += ~a[i + 3] & 1;
+    }
+    for (; i < n; ++i) c0 += ~a[i] & 1;
+    return c0 + c1 + c2 + c3;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Low bit shifted into the sign bit, then movemask packs four parities
+// into the low bits of a GPR.
+SIMD_TARGET("sse2,popcnt")
+static inline long long even_count_sse2(const int *a, size_t n) {
+    long long odd = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int m0 = _mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_loadu_si128((const __m128i *)(a + i)), 31)));
+        int m1 = _mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_loadu_si128((const __m128i *)(a + i + 4)), 31)));
+        int m2 = _mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_loadu_si128((const __m128i *)(a + i + 8)), 31)));
+        int m3 = _mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_loadu_si128((const __m128i *)(a + i + 12)), 31)));
+        odd += _mm_popcnt_u32((unsigned)(m0 | m1 << 4 | m2 << 8 | m3 << 12));
+    }
+    return (long long)i - odd + even_count_branchfree(a + i, n - i);
+}
+
+// Per-lane odd counts stay in vector registers; lanes are int32, so they are
+// flushed to 64 bits before they could overflow. The four accumulators are
+// combined in 32-bit lanes before the flush, so each one is capped at
+// EC_FLUSH_ITERS iterations: 4 * 2^28 = 2^30 stays well inside int32.
+SIMD_TARGET("avx2")
+static inline long long even_count_avx2(const int *a, size_t n) {
+    const __m256i one = _mm256_set1_epi32(1);
+    const size_t flush = EC_FLUSH_ITERS;
+    long long odd = 0;
+    size_t i = 0;
+    while (i + 32 <= n) {
+        size_t end = n - (n - i) % 32;
+        if ((end - i) / 32 > flush) end = i + flush * 32;
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+        __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+        for (; i < end; i += 32) {
+            acc0 = _mm256_add_epi32(acc0, _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + i)), one));
+            acc1 = _mm256_add_epi32(acc1, _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + i + 8)), one));
+            acc2 = _mm256_add_epi32(acc2, _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + i + 16)), one));
+            acc3 = _mm256_add_epi32(acc3, _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + i + 24)), one));
+        }
+        __m256i acc = _mm256_add_epi32(_mm256_add_epi32(acc0, acc1), _mm256_add_epi32(acc2, acc3));
+        int lanes[8];
+        _mm256_storeu_si256((__m256i *)lanes, acc);
+        for (int k = 0; k < 8; ++k) odd += lanes[k];
+    }
+    return (long long)i - odd + even_count_branchfree(a + i, n - i);
+}
+
+// AVX-512 produces the parity mask directly (vptestmd), no shift needed.
+SIMD_TARGET("avx512f,popcnt")
+static inline long long even_count_avx512(const int *a, size_t n) {
+    const __m512i one = _mm512_set1_epi32(1);
+    long long odd = 0;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        unsigned m0 = _mm512_test_epi32_mask(_mm512_loadu_si512((const void *)(a + i)), one);
+        unsigned m1 = _mm512_test_epi32_mask(_mm512_loadu_si512((const void *)(a + i + 16)), one);
+        unsigned m2 = _mm512_test_epi32_mask(_mm512_loadu_si512((const void *)(a + i + 32)), one);
+        unsigned m3 = _mm512_test_epi32_mask(_mm512_loadu_si512((const void *)(a + i + 48)), one);
+        odd += _mm_popcnt_u64((unsigned long long)m0 | (unsigned long long)m1 << 16 |
+                              (unsigned long long)m2 << 32 | (unsigned long long)m3 << 48);
+    }
+    return (long long)i - odd + even_count_branchfree(a + i, n - i);
+}
+
+#endif
+
+#if defined(__aarch64__)
+static inline long long even_count_neon(const int *a, size_t n) {
+    const uint32x4_t one = vdupq_n_u32(1);
+    long long odd = 0;
+    size_t i = 0;
+    while (i + 16 <= n) {
+        size_t end = n - (n - i) % 16;
+        if ((end - i) / 16 > EC_FLUSH_ITERS) end = i + EC_FLUSH_ITERS * 16;
+        uint32x4_t acc0 = vdupq_n_u32(0), acc1 = vdupq_n_u32(0);
+        uint32x4_t acc2 = vdupq_n_u32(0), acc3 = vdupq_n_u32(0);
+        for (; i < end; i += 16) {
+            acc0 = vaddq_u32(acc0, vandq_u32(vld1q_u32((const uint32_t *)(a + i)), one));
+            acc1 = vaddq_u32(acc1, vandq_u32(vld1q_u32((const uint32_t *)(a + i + 4)), one));
+            acc2 = vaddq_u32(acc2, vandq_u32(vld1q_u32((const uint32_t *)(a + i + 8)), one));
+            acc3 = vaddq_u32(acc3, vandq_u32(vld1q_u32((const uint32_t *)(a + i + 12)), one));
+        }
+        odd += vaddlvq_u32(vaddq_u32(vaddq_u32(acc0, acc1), vaddq_u32(acc2, acc3)));
+    }
+    return (long long)i - odd + even_count_branchfree(a + i, n - i);
+}
+#endif
+
+static inline even_count_fn even_count_simd_for(simd_isa_t isa) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case ISA_SSE2:   return __builtin_cpu_supports("popcnt") ? even_count_sse2 : even_count_branchfree;
+        case ISA_AVX2:   return even_count_avx2;
+        case ISA_AVX512: return __builtin_cpu_supports("popcnt") ? even_count_avx512 : even_count_avx2;
+#endif
+#if defined(__aarch64__)
+        case ISA_NEON:   return even_count_neon;
+#endif
+        default:         return even_count_branchfree;
+    }
+}
+
+// Parity sidecar: bit i of bits[] is the low bit of a[i]. Built once, it
+// answers "how many evens in [lo, hi)" while reading 1/32 of the bytes the
+// int array occupies. It must be rebuilt if the array changes.
+typedef struct {
+    uint64_t *bits;
+    size_t n;
+    size_t words;
+} parity_sidecar_t;
+
+static inline int parity_sidecar_build(parity_sidecar_t *ps, const int *a, size_t n) {
+    ps->n = n;
+    ps->words = (n + 63) / 64;
+    ps->bits = (uint64_t *)malloc(sizeof(uint64_t) * (ps->words ? ps->words : 1));
+    if (!ps->bits) return -1;
+
+    uint64_t *bits = ps->bits;
+    long words = (long)ps->words;
+    #pragma omp parallel for schedule(static)
+    for (long w = 0; w < words; ++w) {
+        size_t base = (size_t)w * 64;
+        size_t len = n - base < 64 ? n - base : 64;
+        uint64_t word = 0;
+        for (size_t k = 0; k < len; ++k) word |= (uint64_t)(a[base + k] & 1) << k;
+        bits[w] = word;
+    }
+    return 0;
+}
+
+static inline void parity_sidecar_free(parity_sidecar_t *ps) {
+    free(ps->bits);
+    ps->bits = NULL;
+}
+
+static inline long long parity_popcount_words(const uint64_t *bits, size_t count) {
+    long long odd = 0;
+    for (size_t w = 0; w < count; ++w) odd += __builtin_popcountll(bits[w]);
+    return odd;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+SIMD_TARGET("popcnt")
+static inline long long parity_popcount_words_hw(const uint64_t *bits, size_t count) {
+    long long o0 = 0, o1 = 0, o2 = 0, o3 = 0;
+    size_t w = 0;
+    for (; w + 4 <= count; w += 4) {
+        o0 += _mm_popcnt_u64(bits[w]);
+        o1 += _mm_popcnt_u64(bits[w + 1]);
+        o2 += _mm_popcnt_u64(bits[w + 2]);
+        o3 += _mm_popcnt_u64(bits[w + 3]);
+    }
+    for (; w < count; ++w) o0 += _mm_popcnt_u64(bits[w]);
+    return o0 + o1 + o2 + o3;
+}
+#endif
+
+// Evens among elements [lo, hi); partial words at either end are masked.
+static inline long long parity_sidecar_count_even(const parity_sidecar_t *ps, size_t lo, size_t hi) {
+    if (hi <= lo) return 0;
+    size_t first = lo / 64, last = (hi - 1) / 64;
+    uint64_t head_mask = ~0ULL << (lo % 64);
+    uint64_t tail_mask = (hi % 64) ? (~0ULL >> (64 - hi % 64)) : ~0ULL;
+    long long odd;
+    if (first == last) {
+        odd = __builtin_popcountll(ps->bits[first] & head_mask & tail_mask);
+    } else {
+        odd = __builtin_popcountll(ps->bits[first] & head_mask) + __builtin_popcountll(ps->bits[last] & tail_mask);
+#if defined(__x86_64__) || defined(__i386__)
+        if (__builtin_cpu_supports("popcnt")) {
+            odd += parity_popcount_words_hw(ps->bits + first + 1, last - first - 1);
+        } else
+#endif
+        odd += parity_popcount_words(ps->bits + first + 1, last - first - 1);
+    }
+    return (long long)(hi - lo) - odd;
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef FUSED_AGG_H
+#define FUSED_AGG_H
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "reduce_engine.h"
+#include "simd_sum.h"
+
+// Fused aggregation: several statistics of one int32 array from a single
+// DRAM pass. Each thread walks its schedule(static) range in FA_BLOCK
+// element blocks: one vectorized loop pulls a block into cache and computes
+// all the scalar aggregates, then the histogram re-reads the block from cache
+// in its own loop (its scattered increments would stop the first loop
+// from vectorizing). Results match the reduce_engine.h operators: the even
+// count is RE_STEP_COUNT_EVEN and the histogram uses re_bin() on the same
+// spec.
+
+#ifndef FA_BLOCK
+#define FA_BLOCK 8192   // 32 KB of int32: stays in L1/L2 across the aggregate loops
+#endif
+
+enum {
+    FA_SUM = 1u << 0,
+    FA_COUNT_EVEN = 1u << 1,
+    FA_MIN = 1u << 2,
+    FA_MAX = 1u << 3,
+    FA_HISTOGRAM = 1u << 4,
+    FA_ALL = (1u << 5) - 1,
+    FA_SCALARS = FA_SUM | FA_COUNT_EVEN | FA_MIN | FA_MAX
+};
+
+typedef struct {
+    long long sum;
+    long long even;
+    long long min;
+    long long max;
+    long long *bins;   // caller-provided, spec->nbins entries, FA_HISTOGRAM only
+} fa_result_t;
+
+static inline const char *fa_op_name(unsigned op) {
+    switch (op) {
+    case FA_SUM: return "sum";
+    case FA_COUNT_EVEN: return "count_even";
+    case FA_MIN: return "min";
+    case FA_MAX: return "max";
+    case FA_HISTOGRAM: return "histogram";
+    default: return "?";
+    }
+}
+
+static inline int fa_op_count(unsigned ops) {
+    int n = 0;
+    for (; ops; ops &= ops - 1) n++;
+    return n;
+}
+
+// Comma-separated op names -> mask; NULL or empty means all. Unknown names
+// are ignored.
+static inline unsigned fa_parse_ops(const char *list) {
+    if (!list || !*list) return FA_ALL;
+    unsigned ops = 0;
+    for (unsigned op = 1; op < FA_ALL; op <<= 1) {
+        const char *name = fa_op_name(op);
+        size_t len = strlen(name);
+        for (const char *p = list; (p = strstr(p, name)) != NULL; p += len) {
+            if ((p == list || p[-1] == ',') && (p[len] == '\0' || p[len] == ',')) ops |= op;
+        }
+    }
+    return ops;
+}
+
+typedef struct {
+    long long sum;
+    long long even;
+    int min;
+    int max;
+} fa_partial_t;
+
+// The four scalar aggregates of one block in one loop: each costs a vector
+// op or two per element, well below the load bandwidth. Compiled once per
+// ISA, like the datagen kernels; the block count fits an int.
+#define FA_DEFINE_SCALAR_KERNEL(suffix, ATTR)                                                  \
+ATTR static void fa_scalars_block_##suffix(const int32_t *blk, size_t len, fa_partial_t *p) { \
+    long long s = 0;                                                                           \
+    int c = 0, lo_v = INT_MAX, hi_v = INT_MIN;                                                 \
+    _Pragma("omp simd reduction(+:s, c) reduction(min:lo_v) reduction(max:hi_v)")             \
+    for (size_t i = 0; i < len; ++i) {                                                         \
+        int v = blk[i];                                                                        \
+        s += v;                                                                                \
+        c += (v & 1) == 0;                                                                     \
+        lo_v = v < lo_v ? v : lo_v;                                                            \
+        hi_v = v > hi_v ? v : hi_v;                                                            \
+    }                                                                                          \
+    p->sum += s;                                                                               \
+    p->even += c;                                                                              \
+    if (lo_v < p->min) p->min = lo_v;                                                          \
+    if (hi_v > p->max) p->max = hi_v;                                                          \
+}
+
+typedef void (*fa_scalars_fn)(const int32_t *blk, size_t len, fa_partial_t *p);
+
+FA_DEFINE_SCALAR_KERNEL(default, )
+#if defined(__x86_64__) || defined(__i386__)
+FA_DEFINE_SCALAR_KERNEL(avx2, SIMD_TARGET("avx2"))
+FA_DEFINE_SCALAR_KERNEL(avx512, SIMD_TARGET("avx512f,avx512bw"))
+#endif
+
+static inline fa_scalars_fn fa_select_scalars(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    simd_isa_t isa = simd_isa_select();
+    if (isa == ISA_AVX512 && __builtin_cpu_supports("avx512bw")) return fa_scalars_block_avx512;
+    if (isa >= ISA_AVX2) return fa_scalars_block_avx2;
+#endif
+    return fa_scalars_block_default;
+}
+
+// Returns 0, or -1 if the per-thread histograms cannot be allocated.
+static inline int fa_aggregate_i32(const int32_t *a, size_t n, unsigned ops, const re_hist_spec_t *spec,
+                                   fa_result_t *out) {
+    long long sum = 0, even = 0, mn = LLONG_MAX, mx = LLONG_MIN;
+    const int nb = (ops & FA_HISTOGRAM) ? spec->nbins : 0;
+    const double scale = nb ? nb / (spec->hi - spec->lo) : 0.0;
+    const int stride = (nb + 7) / 8 * 8;   // whole cache lines per thread
+    const fa_scalars_fn scalars = fa_select_scalars();
+    long long *parts = NULL;
+    if (nb) {
+        parts = (long long *)aligned_alloc(RE_CACHE_LINE,
+                                           sizeof(long long) * (size_t)(stride ? stride : 8) * (size_t)omp_get_max_threads());
+        if (!parts) return -1;
+        memset(out->bins, 0, sizeof(long long) * (size_t)nb);
+    }
+
+    #pragma omp parallel reduction(+:sum, even) reduction(min:mn) reduction(max:mx)
+    {
+        size_t lo, hi;
+        static_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+        long long *local = parts ? parts + (size_t)omp_get_thread_num() * stride : NULL;
+        if (local) memset(local, 0, sizeof(long long) * (size_t)nb);
+        fa_partial_t part = { 0, 0, INT_MAX, INT_MIN };
+
+        for (size_t b = lo; b < hi; b += FA_BLOCK) {
+            const int32_t *blk = a + b;
+            const size_t len = hi - b < FA_BLOCK ? hi - b : FA_BLOCK;
+            if (ops & FA_SCALARS) scalars(blk, len, &part);
+            if (local) {
+                for (size_t i = 0; i < len; ++i) local[re_bin((double)blk[i], spec, scale)]++;
+            }
+        }
+        sum += part.sum;
+        even += part.even;
+        if (hi > lo && part.min < mn) mn = part.min;
+        if (hi > lo && part.max > mx) mx = part.max;
+        if (local) {
+            #pragma omp critical
+            for (int k = 0; k < nb; ++k) out->bins[k] += local[k];
+        }
+    }
+
+    out->sum = sum;
+    out->even = even;
+    out->min = mn;
+    out->max = mx;
+    free(parts);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef HOST_INFO_H
+#define HOST_INFO_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
+// Host and build metadata for result records: CPU model, core counts,
+// compiler, the code-generation flags visible to the preprocessor and the
+// OpenMP runtime. The exact command line is not visible from inside the
+// program; build with -DBUILD_CFLAGS='"..."' to record it verbatim.
+
+// Writes the CPU model into buf ("unknown" if it cannot be read).
+static inline void host_cpu_model(char *buf, size_t size) {
+    snprintf(buf, size, "unknown");
+#if defined(__linux__)
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char *colon = strchr(line, ':');
+        if (colon && strncmp(line, "model name", 10) == 0) {
+            colon += 1 + (colon[1] == ' ');
+            colon[strcspn(colon, "\n")] = '\0';
+            snprintf(buf, size, "%s", colon);
+            break;
+        }
+    }
+    fclose(f);
+#elif defined(__APPLE__)
+    size_t len = size;
+    if (sysctlbyname("machdep.cpu.brand_string", buf, &len, NULL, 0) != 0) snprintf(buf, size, "unknown");
+#endif
+}
+
+static inline const char *host_compiler(void) {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+// BUILD_CFLAGS if given, else the flags that can be inferred from
+// predefined macros.
+static inline const char *host_build_flags(void) {
+#ifdef BUILD_CFLAGS
+    return BUILD_CFLAGS;
+#else
+    return ""
+#ifdef __OPTIMIZE__
+        "-O"
+#else
+        "-O0"
+#endif
+#ifdef __FAST_MATH__
+        " -ffast-math"
+#endif
+#ifdef _OPENMP
+        " -fopenmp"
+#endif
+#ifdef __AVX512F__
+        " avx512f"
+#elif defined(__AVX2__)
+        " avx2"
+#elif defined(__SSE2__)
+        " sse2"
+#endif
+#ifdef __FMA__
+        " fma"
+#endif
+#ifdef __ARM_NEON
+        " neon"
+#endif
+#ifdef ENABLE_TRACE
+        " -DENABLE_TRACE"
+#endif
+        ;
+#endif
+}
+
+// Runtime library by compiler family (the OpenMP API has no name query) and
+// the specification version from _OPENMP.
+static inline void host_openmp_runtime(char *buf, size_t size) {
+#if defined(__clang__)
+    const char *lib = "libomp";
+#elif defined(__GNUC__)
+    const char *lib = "libgomp";
+#else
+    const char *lib = "unknown";
+#endif
+    snprintf(buf, size, "%s (_OPENMP %d)", lib, _OPENMP);
+}
+
+#endif
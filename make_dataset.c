@@ -0,0 +1,92 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "dataset_io.h"
+#include "datagen.h"
+
+// Writes a dataset file in the format read by dataset_io.h, with the same
+// contents the benchmarks generate in memory:
+//   ramp    a[i] = i              (part1)
+//   random  a[i] uniform in 0..999 (part3; same seed, same contents)
+//   mod     a[i] = i % 1000       (part4)
+// The payload is produced block by block, so files larger than RAM are fine.
+
+#define WRITE_BLOCK (1u << 20)
+
+static int usage(const char *prog) {
+    fprintf(stderr, "Usage: %s <out.bin> <ramp|random|mod> <count> [int32|int64] [seed]\n", prog);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) return usage(argv[0]);
+    const char *path = argv[1];
+    const char *pattern = argv[2];
+    char *end;
+    errno = 0;
+    uint64_t count = strtoull(argv[3], &end, 10);
+    if (argv[3][0] < '0' || argv[3][0] > '9' || *end != '\0' || errno == ERANGE || count == 0) {
+        fprintf(stderr, "Invalid count '%s': expected a positive integer\n", argv[3]);
+        return usage(argv[0]);
+    }
+    if (argc > 4 && strcmp(argv[4], "int32") != 0 && strcmp(argv[4], "int64") != 0) {
+        fprintf(stderr, "Unknown type '%s'\n", argv[4]);
+        return usage(argv[0]);
+    }
+    uint32_t elem_size = (argc > 4 && strcmp(argv[4], "int64") == 0) ? 8 : 4;
+    uint64_t seed = argc > 5 ? strtoull(argv[5], NULL, 0) : DG_DEFAULT_SEED;
+
+    if (strcmp(pattern, "ramp") != 0 && strcmp(pattern, "random") != 0 && strcmp(pattern, "mod") != 0) {
+        fprintf(stderr, "Unknown pattern '%s'\n", pattern);
+        return 2;
+    }
+
+    FILE *out = fopen(path, "wb");
+    if (!out) { perror(path); return 1; }
+
+    dataset_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, DATASET_MAGIC, sizeof(hdr.magic));
+    hdr.version = DATASET_VERSION;
+    hdr.elem_size = elem_size;
+    hdr.count = count;
+    if (fwrite(&hdr, sizeof(hdr), 1, out) != 1) {
+        perror(path);
+        fclose(out);
+        return 1;
+    }
+
+    int64_t *block = (int64_t *)malloc(sizeof(int64_t) * WRITE_BLOCK);
+    if (!block) {
+        printf("Memory allocation failed!\n");
+        fclose(out);
+        return 1;
+    }
+
+    int is_ramp = strcmp(pattern, "ramp") == 0, is_random = strcmp(pattern, "random") == 0;
+    for (uint64_t base = 0; base < count; base += WRITE_BLOCK) {
+        size_t n = count - base < WRITE_BLOCK ? (size_t)(count - base) : WRITE_BLOCK;
+        for (size_t k = 0; k < n; ++k) {
+            uint64_t i = base + k;
+            int64_t v = is_ramp ? (int64_t)i
+                      : is_random ? (int64_t)dg_random_below(seed, i, 1000)
+                      : (int64_t)(i % 1000);
+            if (elem_size == 4) ((int32_t *)block)[k] = (int32_t)v;
+            else block[k] = v;
+        }
+        if (fwrite(block, elem_size, n, out) != n) {
+            perror(path);
+            free(block);
+            fclose(out);
+            return 1;
+        }
+    }
+
+    free(block);
+    if (fclose(out) != 0) { perror(path); return 1; }
+    printf("Wrote %llu %s elements (%s) to %s\n", (unsigned long long)count,
+           elem_size == 4 ? "int32" : "int64", pattern, path);
+    return 0;
+}
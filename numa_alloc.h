@@ -0,0 +1,180 @@
+#ifndef NUMA_ALLOC_H
+#define NUMA_ALLOC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Allocation layer for the large benchmark arrays. Pages are placed by first
+// touch, so the arrays must be written for the first time by the same
+// schedule(static) partition the compute loops use; every thread then reads
+// memory local to its own socket. Nothing here needs libnuma: node placement
+// is queried with the raw move_pages syscall.
+//
+// NUMA_HUGEPAGES=thp      madvise(MADV_HUGEPAGE) on the mapping
+// NUMA_HUGEPAGES=hugetlb  MAP_HUGETLB (falls back to a normal mapping)
+
+#define NUMA_MAX_NODES 64
+#define NUMA_HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+typedef struct {
+    int *data;
+    size_t n;
+    size_t mapped_bytes;   // 0 when the buffer came from malloc
+    size_t page_size;
+    const char *backing;
+} numa_array_t;
+
+static inline int numa_array_alloc(numa_array_t *arr, size_t n) {
+    size_t bytes = n * sizeof(int);
+    memset(arr, 0, sizeof(*arr));
+    arr->n = n;
+
+#ifdef __linux__
+    const char *huge = getenv("NUMA_HUGEPAGES");
+    size_t base_page = (size_t)sysconf(_SC_PAGESIZE);
+    void *p = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (huge && strcmp(huge, "hugetlb") == 0) {
+        size_t rounded = (bytes + NUMA_HUGE_PAGE_SIZE - 1) & ~(NUMA_HUGE_PAGE_SIZE - 1);
+        p = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            arr->mapped_bytes = rounded;
+            arr->page_size = NUMA_HUGE_PAGE_SIZE;
+            arr->backing = "hugetlb";
+        } else {
+            fprintf(stderr, "MAP_HUGETLB failed (no reserved huge pages?), using normal pages\n");
+        }
+    }
+#endif
+    if (p == MAP_FAILED) {
+        size_t rounded = (bytes + base_page - 1) & ~(base_page - 1);
+        p = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return -1;
+        arr->mapped_bytes = rounded;
+        arr->page_size = base_page;
+        arr->backing = "mmap";
+#ifdef MADV_HUGEPAGE
+        if (huge && strcmp(huge, "thp") == 0 && madvise(p, rounded, MADV_HUGEPAGE) == 0) {
+            arr->backing = "mmap+THP";
+        }
+#endif
+    }
+    arr->data = (int *)p;
+#else
+    arr->data = (int *)malloc(bytes);
+    if (!arr->data) return -1;
+    arr->page_size = 4096;
+    arr->backing = "malloc";
+#endif
+    return 0;
+}
+
+// Zero the array with the compute loops' partition. Only needed when the
+// real contents have to be produced serially afterwards (e.g. rand()).
+static inline void numa_first_touch(numa_array_t *arr) {
+    int *data = arr->data;
+    long n = (long)arr->n;
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < n; ++i) data[i] = 0;
+}
+
+static inline void numa_array_free(numa_array_t *arr) {
+#ifdef __linux__
+    if (arr->data && arr->mapped_bytes) munmap(arr->data, arr->mapped_bytes);
+#else
+    free(arr->data);
+#endif
+    arr->data = NULL;
+}
+
+static inline const char *numa_proc_bind_name(omp_proc_bind_t bind) {
+    switch (bind) {
+        case omp_proc_bind_false:  return "false";
+        case omp_proc_bind_true:   return "true";
+        case omp_proc_bind_master: return "master";
+        case omp_proc_bind_close:  return "close";
+        case omp_proc_bind_spread: return "spread";
+        default:                   return "unknown";
+    }
+}
+
+// Count the array's pages per NUMA node. Returns the number of nodes seen
+// (highest node id + 1), or 0 when placement cannot be queried.
+static inline int numa_page_counts(const numa_array_t *arr, long counts[NUMA_MAX_NODES]) {
+    memset(counts, 0, sizeof(long) * NUMA_MAX_NODES);
+#if defined(__linux__) && defined(SYS_move_pages)
+    enum { BATCH = 4096 };
+    void *pages[BATCH];
+    int status[BATCH];
+    int max_node = -1;
+    char *base = (char *)arr->data;
+    size_t npages = (arr->n * sizeof(int) + arr->page_size - 1) / arr->page_size;
+
+    for (size_t first = 0; first < npages; first += BATCH) {
+        size_t count = npages - first < BATCH ? npages - first : BATCH;
+        for (size_t k = 0; k < count; ++k) pages[k] = base + (first + k) * arr->page_size;
+        if (syscall(SYS_move_pages, 0, count, pages, NULL, status, 0) != 0) return 0;
+        for (size_t k = 0; k < count; ++k) {
+            if (status[k] >= 0 && status[k] < NUMA_MAX_NODES) {
+                counts[status[k]]++;
+                if (status[k] > max_node) max_node = status[k];
+            }
+        }
+    }
+    return max_node + 1;
+#else
+    (void)arr;
+    return 0;
+#endif
+}
+
+// Thread placement and page distribution, printed with the other run
+// parameters so each result can be tied to the layout it ran on.
+static inline void numa_report(const numa_array_t *arr) {
+    const char *bind_env = getenv("OMP_PROC_BIND");
+    const char *places_env = getenv("OMP_PLACES");
+
+    printf("Memory: %zu MB, backing %s, page size %zu KB\n",
+           arr->n * sizeof(int) / (1024 * 1024), arr->backing, arr->page_size / 1024);
+    printf("OMP_PROC_BIND=%s (runtime: %s), OMP_PLACES=%s (%d places)\n",
+           bind_env ? bind_env : "<unset>", numa_proc_bind_name(omp_get_proc_bind()),
+           places_env ? places_env : "<unset>", omp_get_num_places());
+    if (omp_get_proc_bind() == omp_proc_bind_false) {
+        printf("Note: threads are not pinned; set OMP_PROC_BIND=spread OMP_PLACES=cores for a NUMA study\n");
+    }
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int cpu = -1;
+#if defined(__linux__) && defined(SYS_getcpu)
+        unsigned cpu_id = 0;
+        if (syscall(SYS_getcpu, &cpu_id, NULL, NULL) == 0) cpu = (int)cpu_id;
+#endif
+        #pragma omp critical
+        {
+            printf("  thread %2d -> place %2d, cpu %3d\n", tid, omp_get_place_num(), cpu);
+        }
+    }
+
+    long counts[NUMA_MAX_NODES];
+    int nodes = numa_page_counts(arr, counts);
+    if (nodes > 0) {
+        printf("Pages per NUMA node:");
+        for (int node = 0; node < nodes; ++node) printf(" node%d=%ld", node, counts[node]);
+        printf("\n");
+    } else {
+        printf("Pages per NUMA node: unavailable on this platform\n");
+    }
+}
+
+#endif
@@ -1,87 +1,285 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <omp.h>
+#include "dataset_io.h"
+#include "datagen.h"
+#include "numa_alloc.h"
+#include "perf_counters.h"
+#include "reduce_engine.h"
+#include "shard_counter.h"
+#include "simd_sum.h"
+#include "stream_peak.h"
+#include "trace.h"
 
 #define ARRAY_SIZE 100000000
+#define SIMD_TRIALS 3
+
+// Time one SIMD kernel single-threaded and across the whole team, best of
+// SIMD_TRIALS each, and report the achieved bandwidth against the STREAM peak.
+static void run_simd_kernel(simd_isa_t isa, const int *array, long array_size, double peak_gbs, long long expected,
+                            double *single_time_out, double *parallel_time_out) {
+    sum_kernel_fn kernel = sum_kernel_for(isa);
+    const double bytes = (double)array_size * sizeof(int);
+    double single_best = 1e100, parallel_best = 1e100;
+    long long single_sum = 0, parallel_sum = 0;
+    static perf_sample_t single_counters, parallel_counters;
+
+    // counters are read around the last trial only
+    for (int t = 0; t < SIMD_TRIALS; ++t) {
+        int counted = t == SIMD_TRIALS - 1;
+        if (counted) perf_begin_serial(&single_counters);
+        double t0 = omp_get_wtime();
+        single_sum = kernel(array, array_size);
+        double t1 = omp_get_wtime();
+        if (counted) perf_end(&single_counters);
+        if (t1 - t0 < single_best) single_best = t1 - t0;
+
+        if (counted) perf_begin(&parallel_counters);
+        t0 = omp_get_wtime();
+        TRACE_REGION_BEGIN("part1/simd %s", simd_isa_name(isa));
+        parallel_sum = sum_i32_parallel(kernel, array, array_size);
+        TRACE_REGION_END();
+        t1 = omp_get_wtime();
+        if (counted) perf_end(&parallel_counters);
+        if (t1 - t0 < parallel_best) parallel_best = t1 - t0;
+    }
+
+    double single_gbs = bytes / single_best / 1e9;
+    double parallel_gbs = bytes / parallel_best / 1e9;
+    printf("[%s] 1 thread: sum %lld, %f seconds, %.2f GB/s", simd_isa_name(isa), single_sum, single_best, single_gbs);
+    if (peak_gbs > 0) printf(" (%.1f%% of peak)", single_gbs / peak_gbs * 100);
+    printf("\n");
+    perf_print_row("counters", &single_counters, (double)array_size);
+    printf("[%s] %d threads: sum %lld, %f seconds, %.2f GB/s", simd_isa_name(isa), omp_get_max_threads(),
+           parallel_sum, parallel_best, parallel_gbs);
+    if (peak_gbs > 0) printf(" (%.1f%% of peak)", parallel_gbs / peak_gbs * 100);
+    printf("\n");
+    perf_print_row("counters", &parallel_counters, (double)array_size);
+    if (single_sum != expected || parallel_sum != expected) {
+        printf("[%s] ✗ sum mismatch (expected %lld)\n", simd_isa_name(isa), expected);
+    }
+
+    *single_time_out = single_best;
+    *parallel_time_out = parallel_best;
+}
+
+// Streaming mode: the reduction loop below runs unchanged on each block
+// while the next block is read in the background.
+static void sum_block(const void *block, size_t count, uint32_t elem_size, void *ctx) {
+    long long block_sum = 0;
+    long n = (long)count;
+    TRACE_REGION_BEGIN("part1/stream block");
+    if (elem_size == 4) {
+        const int *array = (const int *)block;
+        #pragma omp parallel for reduction(+:block_sum) schedule(static)
+        for (long i = 0; i < n; i++) {
+            block_sum += array[i];
+        }
+    } else {
+        const long long *array = (const long long *)block;
+        #pragma omp parallel for reduction(+:block_sum) schedule(static)
+        for (long i = 0; i < n; i++) {
+            block_sum += array[i];
+        }
+    }
+    TRACE_REGION_END();
+    *(long long *)ctx += block_sum;
+}
+
+static int run_streaming(const char *path) {
+    long long stream_sum = 0;
+    dataset_header_t hdr;
+    dataset_stream_stats_t stats;
+    
+    printf("=== STREAMING REDUCTION (%s) ===\n", path);
+    if (dataset_stream(path, DATASET_CHUNK_ELEMS, sum_block, &stream_sum, &hdr, &stats) != 0) return 1;
+    printf("Elements: %llu x int%u, %d threads\n", (unsigned long long)hdr.count, hdr.elem_size * 8, omp_get_max_threads());
+    printf("Streamed sum: %lld\n", stream_sum);
+    dataset_stream_report(&stats);
+    return 0;
+}
 
 int main() {
+    numa_array_t storage = {0};
+    dataset_t dataset = {0};
+    const char *dataset_path = getenv("DATASET");
+    const char *dataset_mode = getenv("DATASET_MODE");
+    long array_size = ARRAY_SIZE;
     int *array;
     long long sequential_sum = 0;
     long long parallel_sum_no_reduction = 0;
     long long parallel_sum_with_reduction = 0;
-    double start_time, end_time;
+    long long slots_sum = 0, tree_sum = 0;
+    double start_time, end_time, setup_time = 0.0;
     double sequential_time, parallel_time_no_reduction, parallel_time_with_reduction;
     
-    // Allocate memory for array
-    array = (int *)malloc(ARRAY_SIZE * sizeof(int));
-    if (array == NULL) {
-        printf("Memory allocation failed!\n");
-        return 1;
+    // DATASET=<file> replaces the generated array with a file written by
+    // make_dataset; DATASET_MODE=stream reads it in blocks instead of mapping it
+    if (dataset_path && dataset_mode && strcmp(dataset_mode, "stream") == 0) {
+        return run_streaming(dataset_path);
     }
     
-    // Initialize array with values 0 to 99,999,999
-    for (int i = 0; i < ARRAY_SIZE; i++) {
-        array[i] = i;
+    if (dataset_path) {
+        if (dataset_map(dataset_path, &dataset) != 0) return 1;
+        if (dataset.header.elem_size != sizeof(int)) {
+            printf("%s holds int64 elements; run it with DATASET_MODE=stream\n", dataset_path);
+            dataset_unmap(&dataset);
+            return 1;
+        }
+        array = (int *)dataset.data;
+        array_size = (long)dataset.header.count;
+    } else {
+        double setup_start = omp_get_wtime();
+        // Allocate memory for array
+        if (numa_array_alloc(&storage, ARRAY_SIZE) != 0) {
+            printf("Memory allocation failed!\n");
+            return 1;
+        }
+        array = storage.data;
+        
+        // Initialize array with values 0 to 99,999,999; the parallel first touch
+        // places each page on the node of the thread that will later sum it
+        TRACE_REGION_BEGIN("part1/init");
+        dg_fill_ramp(array, ARRAY_SIZE, 0);
+        TRACE_REGION_END();
+        setup_time = omp_get_wtime() - setup_start;
     }
     
-    printf("Array size: %d elements\n", ARRAY_SIZE);
+    printf("Array size: %ld elements\n", array_size);
     printf("Number of threads available: %d\n", omp_get_max_threads());
+    if (!dataset_path) printf("Setup time (allocation + ramp fill): %f seconds\n", setup_time);
+    perf_print_status();
+    if (dataset_path) {
+        printf("Input: %s (mmap, MADV_SEQUENTIAL)\n", dataset_path);
+    } else {
+        TRACE_REGION_BEGIN("part1/placement report");
+        numa_report(&storage);
+        TRACE_REGION_END();
+    }
     printf("\n");
     
     // SEQUENTIAL VERSION
     printf("=== SEQUENTIAL VERSION ===\n");
+    perf_sample_t counters;
+    perf_begin_serial(&counters);
     start_time = omp_get_wtime();
     
-    for (int i = 0; i < ARRAY_SIZE; i++) {
-        sequential_sum += array[i];
-    }
+    re_sum_i32(array, (size_t)array_size, RE_SEQUENTIAL, &sequential_sum);
     
     end_time = omp_get_wtime();
+    perf_end(&counters);
     sequential_time = end_time - start_time;
     
     printf("Sequential sum: %lld\n", sequential_sum);
     printf("Sequential time: %f seconds\n", sequential_time);
+    perf_print_row("counters", &counters, (double)array_size);
     printf("\n");
     
     // PARALLEL VERSION WITHOUT REDUCTION
     printf("=== PARALLEL VERSION WITHOUT REDUCTION ===\n");
+    perf_begin(&counters);
     start_time = omp_get_wtime();
     
+    TRACE_REGION_BEGIN("part1/critical");
+    re_sum_i32(array, (size_t)array_size, RE_CRITICAL, &parallel_sum_no_reduction);
+    TRACE_REGION_END();
+    
+    end_time = omp_get_wtime();
+    perf_end(&counters);
+    parallel_time_no_reduction = end_time - start_time;
+    
+    printf("Parallel sum (no reduction): %lld\n", parallel_sum_no_reduction);
+    printf("Parallel time (no reduction): %f seconds\n", parallel_time_no_reduction);
+    perf_print_row("counters", &counters, (double)array_size);
+    printf("\n");
+    
+    // PARALLEL VERSIONS WITH LOCK-FREE MERGES
+    // The same local sums as above, merged without the critical section:
+    // through padded per-thread slots and through a combining tree.
+    printf("=== PARALLEL VERSIONS WITH LOCK-FREE MERGE ===\n");
+    sc_slots_t slots;
+    if (sc_slots_init(&slots, omp_get_max_threads(), 1) != 0) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+    
+    start_time = omp_get_wtime();
+    TRACE_REGION_BEGIN("part1/padded slots");
     #pragma omp parallel
     {
         long long local_sum = 0;
-        #pragma omp for
-        for (int i = 0; i < ARRAY_SIZE; i++) {
+        #pragma omp for schedule(static)
+        for (long i = 0; i < array_size; i++) {
             local_sum += array[i];
         }
-        
-        #pragma omp critical
-        {
-            parallel_sum_no_reduction += local_sum;
-        }
+        sc_slots_add(&slots, omp_get_thread_num(), local_sum);
     }
-    
+    TRACE_REGION_END();
     end_time = omp_get_wtime();
-    parallel_time_no_reduction = end_time - start_time;
+    slots_sum = sc_slots_total(&slots);
+    printf("Padded slots: sum %lld, %f seconds %s\n", slots_sum, end_time - start_time,
+           slots_sum == sequential_sum ? "✓" : "✗");
     
-    printf("Parallel sum (no reduction): %lld\n", parallel_sum_no_reduction);
-    printf("Parallel time (no reduction): %f seconds\n", parallel_time_no_reduction);
+    start_time = omp_get_wtime();
+    TRACE_REGION_BEGIN("part1/tree merge");
+    if (re_sum_i32(array, (size_t)array_size, RE_TREE, &tree_sum) != 0) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+    TRACE_REGION_END();
+    end_time = omp_get_wtime();
+    printf("Tree merge: sum %lld, %f seconds %s\n", tree_sum, end_time - start_time,
+           tree_sum == sequential_sum ? "✓" : "✗");
+    sc_slots_free(&slots);
     printf("\n");
     
     // PARALLEL VERSION WITH REDUCTION
     printf("=== PARALLEL VERSION WITH REDUCTION ===\n");
+    perf_begin(&counters);
     start_time = omp_get_wtime();
     
-    #pragma omp parallel for reduction(+:parallel_sum_with_reduction)
-    for (int i = 0; i < ARRAY_SIZE; i++) {
-        parallel_sum_with_reduction += array[i];
-    }
+    TRACE_REGION_BEGIN("part1/reduction");
+    re_sum_i32(array, (size_t)array_size, RE_REDUCTION, &parallel_sum_with_reduction);
+    TRACE_REGION_END();
     
     end_time = omp_get_wtime();
+    perf_end(&counters);
     parallel_time_with_reduction = end_time - start_time;
     
     printf("Parallel sum (with reduction): %lld\n", parallel_sum_with_reduction);
     printf("Parallel time (with reduction): %f seconds\n", parallel_time_with_reduction);
+    perf_print_row("counters", &counters, (double)array_size);
+    printf("\n");
+    
+    // SIMD KERNELS
+    // Every supported ISA runs by default; SUM_KERNEL=<isa> restricts the
+    // section to one kernel. The dispatched kernel (SIMD_ISA overrides the
+    // CPUID choice) is the single-core baseline used in the analysis below.
+    simd_isa_t dispatched_isa = simd_isa_select();
+    const char *only_kernel = getenv("SUM_KERNEL");
+    TRACE_REGION_BEGIN("part1/stream triad peak");
+    double peak_gbs = stream_peak_gbs();
+    TRACE_REGION_END();
+    double simd_single_time = 0.0, simd_parallel_time = 0.0;
+    
+    printf("=== SIMD KERNELS (runtime dispatch: %s) ===\n", simd_isa_name(dispatched_isa));
+    if (peak_gbs > 0) {
+        printf("STREAM triad peak: %.2f GB/s (%d threads)\n", peak_gbs, omp_get_max_threads());
+    } else {
+        printf("STREAM triad peak: unavailable (allocation failed)\n");
+    }
+    for (int k = 0; k < ISA_COUNT; ++k) {
+        simd_isa_t isa = (simd_isa_t)k;
+        if (!simd_isa_supported(isa)) continue;
+        if (only_kernel && strcmp(only_kernel, simd_isa_name(isa)) != 0 && isa != dispatched_isa) continue;
+        double single_time, parallel_time;
+        run_simd_kernel(isa, array, array_size, peak_gbs, sequential_sum, &single_time, &parallel_time);
+        if (isa == dispatched_isa) {
+            simd_single_time = single_time;
+            simd_parallel_time = parallel_time;
+        }
+    }
     printf("\n");
     
     // RESULTS ANALYSIS
@@ -99,15 +297,28 @@ int main() {
     printf("Efficiency (with reduction): %.2f%%\n", (sequential_time / parallel_time_with_reduction) / omp_get_max_threads() * 100);
     printf("\n");
     
+    printf("Single-core SIMD baseline (%s): %f seconds (%.2fx over scalar loop)\n",
+           simd_isa_name(dispatched_isa), simd_single_time, sequential_time / simd_single_time);
+    printf("Speedup over SIMD baseline (no reduction): %.2fx\n", simd_single_time / parallel_time_no_reduction);
+    printf("Speedup over SIMD baseline (with reduction): %.2fx\n", simd_single_time / parallel_time_with_reduction);
+    printf("Speedup over SIMD baseline (parallel %s): %.2fx\n", simd_isa_name(dispatched_isa), simd_single_time / simd_parallel_time);
+    printf("\n");
+    
     // Verify correctness
-    if (sequential_sum == parallel_sum_no_reduction && sequential_sum == parallel_sum_with_reduction) {
+    if (sequential_sum == parallel_sum_no_reduction && sequential_sum == parallel_sum_with_reduction &&
+        sequential_sum == slots_sum && sequential_sum == tree_sum) {
         printf("✓ All results are correct and consistent\n");
     } else {
         printf("✗ Results are inconsistent!\n");
-        printf("Sequential: %lld, Parallel (no reduction): %lld, Parallel (with reduction): %lld\n",
-               sequential_sum, parallel_sum_no_reduction, parallel_sum_with_reduction);
+        printf("Sequential: %lld, Parallel (no reduction): %lld, Parallel (with reduction): %lld, "
+               "Padded slots: %lld, Tree merge: %lld\n",
+               sequential_sum, parallel_sum_no_reduction, parallel_sum_with_reduction, slots_sum, tree_sum);
     }
     
-    free(array);
+    if (dataset_path) {
+        dataset_unmap(&dataset);
+    } else {
+        numa_array_free(&storage);
+    }
     return 0;
 }
\ No newline at end of file
@@ -2,33 +2,77 @@
 #include <stdlib.h>
 #include <string.h>
 #include <omp.h>
+#include "batch_exec.h"
+#include "repro_sum.h"
+#include "sched_tune.h"
+#include "weighted_partition.h"
+#include "trace.h"
+#include "uneven_work.h"
+#include "worksteal.h"
 
 #ifndef N
 #define N 5000                 
 #endif
 #define BASE_WORK 40            
 #define WORK_DIVISOR 2500       
+#ifdef ENABLE_TRACE
+#define PRINT_FIRST 0           // the critical-section prints would distort the trace
+#else
 #define PRINT_FIRST 20         
+#endif
 
-static inline double simulate_work(int iteration) {
-    int work_amount = BASE_WORK + (int)((1.0 * iteration * iteration) / WORK_DIVISOR);
+static inline int work_amount_for(int iteration) {
+    return uw_work_amount(iteration, BASE_WORK, WORK_DIVISOR);
+}
 
-    volatile double acc = 0.0; 
-    for (int k = 0; k < work_amount; ++k) {
-        acc += (iteration * 1315423911u + k * 2654435761u) * 1e-12;
-        acc -= (k & 7) * 1e-12;
-    }
-    return acc;
+// Every run accumulates through result_acc_t. By default it is the plain
+// double reduction; with REPRO_SUM=1 the terms go into the exact
+// superaccumulator instead, so "Total result" is bit-identical across
+// schedules, chunk sizes and thread counts and can be diffed.
+static int g_repro_sum = 0;
+
+typedef struct {
+    double plain;
+    repro_acc_t exact;
+} result_acc_t;
+
+static inline void result_acc_init(result_acc_t *r) {
+    r->plain = 0.0;
+    if (g_repro_sum) repro_acc_init(&r->exact);
+}
+
+static inline void result_acc_add(result_acc_t *r, double x) {
+    if (g_repro_sum) repro_acc_add(&r->exact, x);
+    else r->plain += x;
+}
+
+static inline void result_acc_merge(result_acc_t *into, const result_acc_t *from) {
+    if (g_repro_sum) repro_acc_merge(&into->exact, &from->exact);
+    else into->plain += from->plain;
+}
+
+#pragma omp declare reduction(result_add : result_acc_t : result_acc_merge(&omp_out, &omp_in)) \
+    initializer(result_acc_init(&omp_priv))
+
+static void print_total_result(const result_acc_t *r) {
+    if (g_repro_sum) printf("Total result: %.17g (reproducible)\n", repro_acc_value(&r->exact));
+    else printf("Total result: %.6f\n", r->plain);
+}
+
+static inline double simulate_work(int iteration) {
+    return uw_simulate(iteration, BASE_WORK, WORK_DIVISOR);
 }
 
 static void run_static(int chunk_size) {
     double start_time = omp_get_wtime();
-    double total_result = 0.0;
+    result_acc_t total_result;
+    result_acc_init(&total_result);
+    TRACE_REGION_BEGIN("part2/static,%d", chunk_size);
 
     if (chunk_size > 0) {
-        #pragma omp parallel for schedule(static, chunk_size) reduction(+:total_result)
+        #pragma omp parallel for schedule(static, chunk_size) reduction(result_add:total_result)
         for (int i = 0; i < N; i++) {
-            total_result += simulate_work(i);
+            result_acc_add(&total_result, simulate_work(i));
             if (i < PRINT_FIRST) {
                 #pragma omp critical
                 {
@@ -37,9 +81,9 @@ static void run_static(int chunk_size) {
             }
         }
     } else {
-        #pragma omp parallel for schedule(static) reduction(+:total_result)
+        #pragma omp parallel for schedule(static) reduction(result_add:total_result)
         for (int i = 0; i < N; i++) {
-            total_result += simulate_work(i);
+            result_acc_add(&total_result, simulate_work(i));
             if (i < PRINT_FIRST) {
                 #pragma omp critical
                 {
@@ -48,20 +92,23 @@ static void run_static(int chunk_size) {
             }
         }
     }
+    TRACE_REGION_END();
 
     double end_time = omp_get_wtime();
     printf("Execution time (static%s%d): %.6f s\n",
            chunk_size>0?", ":"", chunk_size>0?chunk_size:0, end_time - start_time);
-    printf("Total result: %.6f\n", total_result);
+    print_total_result(&total_result);
 }
 
 static void run_dynamic(int chunk_size) {
     double start_time = omp_get_wtime();
-    double total_result = 0.0;
+    result_acc_t total_result;
+    result_acc_init(&total_result);
+    TRACE_REGION_BEGIN("part2/dynamic,%d", chunk_size);
 
-    #pragma omp parallel for schedule(dynamic, chunk_size) reduction(+:total_result)
+    #pragma omp parallel for schedule(dynamic, chunk_size) reduction(result_add:total_result)
     for (int i = 0; i < N; i++) {
-        total_result += simulate_work(i);
+        result_acc_add(&total_result, simulate_work(i));
         if (i < PRINT_FIRST) {
             #pragma omp critical
             {
@@ -69,19 +116,22 @@ static void run_dynamic(int chunk_size) {
             }
         }
     }
+    TRACE_REGION_END();
 
     double end_time = omp_get_wtime();
     printf("Execution time (dynamic, %d): %.6f s\n", chunk_size, end_time - start_time);
-    printf("Total result: %.6f\n", total_result);
+    print_total_result(&total_result);
 }
 
 static void run_guided(int chunk_size) {
     double start_time = omp_get_wtime();
-    double total_result = 0.0;
+    result_acc_t total_result;
+    result_acc_init(&total_result);
+    TRACE_REGION_BEGIN("part2/guided,%d", chunk_size);
 
-    #pragma omp parallel for schedule(guided, chunk_size) reduction(+:total_result)
+    #pragma omp parallel for schedule(guided, chunk_size) reduction(result_add:total_result)
     for (int i = 0; i < N; i++) {
-        total_result += simulate_work(i);
+        result_acc_add(&total_result, simulate_work(i));
         if (i < PRINT_FIRST) {
             #pragma omp critical
             {
@@ -89,21 +139,435 @@ static void run_guided(int chunk_size) {
             }
         }
     }
+    TRACE_REGION_END();
 
     double end_time = omp_get_wtime();
     printf("Execution time (guided, %d): %.6f s\n", chunk_size, end_time - start_time);
-    printf("Total result: %.6f\n", total_result);
+    print_total_result(&total_result);
+}
+
+typedef struct {
+    _Alignas(64) result_acc_t partial;
+} padded_sum_t;
+
+typedef struct {
+    int chunk_size;
+    padded_sum_t *sums;
+} worksteal_ctx_t;
+
+static void worksteal_body(int lo, int hi, int tid, void *arg) {
+    worksteal_ctx_t *ctx = (worksteal_ctx_t *)arg;
+    result_acc_t acc;
+    result_acc_init(&acc);
+    for (int i = lo; i < hi; i++) {
+        result_acc_add(&acc, simulate_work(i));
+        if (i < PRINT_FIRST) {
+            #pragma omp critical
+            {
+                printf("[worksteal,%d] thread %d -> i=%d\n", ctx->chunk_size, tid, i);
+            }
+        }
+    }
+    result_acc_merge(&ctx->sums[tid].partial, &acc);
+}
+
+static void run_worksteal(int chunk_size) {
+    int max_threads = omp_get_max_threads();
+    ws_thread_stats_t *stats = (ws_thread_stats_t *)aligned_alloc(WS_CACHE_LINE, sizeof(ws_thread_stats_t) * max_threads);
+    padded_sum_t *sums = (padded_sum_t *)aligned_alloc(64, sizeof(padded_sum_t) * max_threads);
+    if (!stats || !sums) {
+        printf("Memory allocation failed!\n");
+        free(stats); free(sums);
+        return;
+    }
+    for (int t = 0; t < max_threads; t++) result_acc_init(&sums[t].partial);
+    worksteal_ctx_t ctx = { chunk_size, sums };
+
+    double start_time = omp_get_wtime();
+    TRACE_REGION_BEGIN("part2/worksteal,%d", chunk_size);
+    int team = ws_parallel_for(N, chunk_size, worksteal_body, &ctx, stats);
+    TRACE_REGION_END();
+    double end_time = omp_get_wtime();
+
+    result_acc_t total_result;
+    result_acc_init(&total_result);
+    long long steals = 0, failed = 0;
+    double busy_max = 0.0, busy_sum = 0.0;
+    for (int t = 0; t < team; t++) {
+        result_acc_merge(&total_result, &sums[t].partial);
+        steals += stats[t].steals;
+        failed += stats[t].failed_steals;
+        busy_sum += stats[t].busy_time;
+        if (stats[t].busy_time > busy_max) busy_max = stats[t].busy_time;
+    }
+
+    printf("Execution time (worksteal, %d): %.6f s\n", chunk_size, end_time - start_time);
+    print_total_result(&total_result);
+    printf("Steals: %lld, failed steal attempts: %lld, busy max/mean: %.3f\n",
+           steals, failed, team > 0 && busy_sum > 0 ? busy_max / (busy_sum / team) : 0.0);
+    for (int t = 0; t < team; t++) {
+        printf("  thread %2d: busy %.6f s, grains %lld, steals %lld, failed %lld\n",
+               t, stats[t].busy_time, stats[t].ranges, stats[t].steals, stats[t].failed_steals);
+    }
+
+    free(stats);
+    free(sums);
+}
+
+static double closed_form_cost(int i, void *ctx) {
+    (void)ctx;
+    return (double)work_amount_for(i);
+}
+
+// Runs the loop over a precomputed partition of nparts blocks with no
+// runtime coordination and returns max thread time / mean thread time.
+// Normally one block per thread; if the team comes out smaller (thread
+// limit, nested region), thread t runs blocks t, t + team, ... so no
+// block is dropped.
+static double run_partitioned(const int *bounds, int nparts, const char *label, result_acc_t *total_out) {
+    int max_threads = omp_get_max_threads();
+    double *thread_time = (double *)calloc(max_threads, sizeof(double));
+    result_acc_t total_result;
+    int team = 0;
+    result_acc_init(&total_result);
+    if (!thread_time) { *total_out = total_result; return 0.0; }
+
+    TRACE_REGION_BEGIN("part2/%s", label);
+    #pragma omp parallel reduction(result_add:total_result)
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        if (tid == 0) team = nthreads;
+        double t0 = omp_get_wtime();
+        for (int part = tid; part < nparts; part += nthreads) {
+            for (int i = bounds[part]; i < bounds[part + 1]; i++) {
+                result_acc_add(&total_result, simulate_work(i));
+                if (i < PRINT_FIRST) {
+                    #pragma omp critical
+                    {
+                        printf("[%s] thread %d -> i=%d\n", label, tid, i);
+                    }
+                }
+            }
+        }
+        thread_time[tid] = omp_get_wtime() - t0;
+    }
+    TRACE_REGION_END();
+
+    double max_time = 0.0, sum_time = 0.0;
+    for (int t = 0; t < team; t++) {
+        sum_time += thread_time[t];
+        if (thread_time[t] > max_time) max_time = thread_time[t];
+    }
+    free(thread_time);
+    *total_out = total_result;
+    return sum_time > 0 ? max_time / (sum_time / team) : 1.0;
+}
+
+static void run_weighted_static(void) {
+    int nthreads = omp_get_max_threads();
+    int *bounds = (int *)malloc(sizeof(int) * (nthreads + 1));
+    if (!bounds || wp_partition_cost(N, closed_form_cost, NULL, nthreads, bounds) != 0) {
+        printf("Memory allocation failed!\n");
+        free(bounds);
+        return;
+    }
+
+    result_acc_t total_result;
+    double start_time = omp_get_wtime();
+    double imbalance = run_partitioned(bounds, nthreads, "weighted", &total_result);
+    double end_time = omp_get_wtime();
+
+    printf("Execution time (weighted static, cost model): %.6f s\n", end_time - start_time);
+    print_total_result(&total_result);
+    printf("Imbalance (max/mean thread time): %.3f\n", imbalance);
+    free(bounds);
+}
+
+// First call times blocks under schedule(dynamic) and learns the partition;
+// later calls reuse it without re-measuring.
+static void run_weighted_adaptive(wp_adaptive_t *model) {
+    int nthreads = omp_get_max_threads();
+    result_acc_t total_result;
+    double start_time = omp_get_wtime();
+    result_acc_init(&total_result);
+
+    if (wp_adaptive_begin(model, N, nthreads)) {
+        if (!model->bounds || !model->block_time) {
+            printf("Memory allocation failed!\n");
+            return;
+        }
+        int blocks = wp_adaptive_blocks(N);
+        TRACE_REGION_BEGIN("part2/adaptive learning");
+        #pragma omp parallel for schedule(dynamic, 1) reduction(result_add:total_result)
+        for (int b = 0; b < blocks; b++) {
+            double t0 = omp_get_wtime();
+            int end = (b + 1) * WP_LEARN_BLOCK < N ? (b + 1) * WP_LEARN_BLOCK : N;
+            for (int i = b * WP_LEARN_BLOCK; i < end; i++) result_acc_add(&total_result, simulate_work(i));
+            wp_adaptive_record(model, b, omp_get_wtime() - t0);
+        }
+        TRACE_REGION_END();
+        wp_adaptive_finish(model);
+        double end_time = omp_get_wtime();
+        printf("Execution time (weighted adaptive, learning pass): %.6f s\n", end_time - start_time);
+        print_total_result(&total_result);
+        return;
+    }
+
+    double imbalance = run_partitioned(model->bounds, model->nparts, "adaptive", &total_result);
+    double end_time = omp_get_wtime();
+    printf("Execution time (weighted adaptive, learned partition): %.6f s\n", end_time - start_time);
+    print_total_result(&total_result);
+    printf("Imbalance (max/mean thread time): %.3f\n", imbalance);
+}
+
+// The same loop under schedule(runtime), without the progress prints, for
+// the autotuner and the tuned run.
+static void run_runtime_loop(void *arg) {
+    result_acc_t *out = (result_acc_t *)arg;
+    result_acc_t total_result;
+    result_acc_init(&total_result);
+    #pragma omp parallel for schedule(runtime) reduction(result_add:total_result)
+    for (int i = 0; i < N; i++) result_acc_add(&total_result, simulate_work(i));
+    *out = total_result;
+}
+
+static void run_autotuned(void) {
+    int max_threads = omp_get_max_threads();
+    result_acc_t total_result;
+    st_result_t tuned;
+    TRACE_REGION_BEGIN("part2/autotune");
+    int status = st_tune("part2/simulate_work", N, run_runtime_loop, &total_result, &tuned);
+    TRACE_REGION_END();
+    if (status != 0) {
+        printf("Autotuning failed\n");
+        return;
+    }
+    if (tuned.from_cache) {
+        printf("Tuned configuration from %s (machine %016llx), lookup %.6f s\n",
+               st_cache_path(), tuned.fingerprint, tuned.tuning_seconds);
+    } else {
+        printf("Tuning: %d timed runs in %.3f s, saved to %s (machine %016llx)\n",
+               tuned.evaluations, tuned.tuning_seconds, st_cache_path(), tuned.fingerprint);
+    }
+
+    st_apply(&tuned.best);
+    double start_time = omp_get_wtime();
+    TRACE_REGION_BEGIN("part2/tuned %s,%d", st_kind_name(tuned.best.kind), tuned.best.chunk);
+    run_runtime_loop(&total_result);
+    TRACE_REGION_END();
+    double end_time = omp_get_wtime();
+    omp_set_num_threads(max_threads);
+
+    char chunk[16];
+    if (tuned.best.chunk > 0) snprintf(chunk, sizeof(chunk), "%d", tuned.best.chunk);
+    else snprintf(chunk, sizeof(chunk), "default");
+    printf("Execution time (tuned: %s,%s, %d threads): %.6f s\n", st_kind_name(tuned.best.kind), chunk,
+           tuned.best.threads, end_time - start_time);
+    print_total_result(&total_result);
+    printf("Tuned best time: %.6f s, best single run seen while tuning: %.6f s (gap %.1f%%)\n",
+           tuned.best.seconds, tuned.best_seen, (tuned.best.seconds / tuned.best_seen - 1.0) * 100.0);
+    if (tuned.default_seconds > 0) {
+        printf("Speedup over schedule(static) with %d threads: %.2fx\n", max_threads,
+               tuned.default_seconds / tuned.best.seconds);
+    }
+}
+
+#define REPRO_BENCH_ELEMENTS (1 << 22)
+
+typedef struct {
+    const char *name;
+    omp_sched_t kind;
+    int chunk;
+} repro_schedule_t;
+
+// Sums the same terms (the per-iteration results, tiled and scaled so every
+// tile contributes different low bits) under several schedules and team
+// sizes: plain reduction, exact superaccumulator, blocked pairwise. The
+// terms are precomputed so the timings isolate the summation itself.
+static void run_repro_comparison(double workload_seconds) {
+    static const repro_schedule_t schedules[] = {
+        { "static", omp_sched_static, 0 },
+        { "dynamic,1024", omp_sched_dynamic, 1024 },
+        { "guided,64", omp_sched_guided, 64 },
+    };
+    const int nsched = (int)(sizeof(schedules) / sizeof(schedules[0]));
+    int max_threads = omp_get_max_threads();
+    int thread_counts[] = { 1, 2, 4, max_threads };
+    const int nthread_counts = max_threads > 4 ? 4 : 3;
+    size_t n = REPRO_BENCH_ELEMENTS;
+    double *terms = (double *)malloc(sizeof(double) * n);
+    if (!terms) {
+        printf("Memory allocation failed!\n");
+        return;
+    }
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < N; i++) terms[i] = simulate_work(i);
+    for (size_t i = N; i < n; i++) terms[i] = terms[i % N] * (1.0 + (double)(i / N) * 1e-7);
+
+    double first_plain = 0.0, first_exact = 0.0, first_blocked = 0.0;
+    int plain_differs = 0, exact_differs = 0, blocked_differs = 0;
+    double plain_time = 0.0, exact_time = 0.0, blocked_time = 0.0;
+    int configs = 0;
+
+    printf("%-12s %-8s %-24s %-24s %s\n", "Schedule", "Threads", "Plain", "Exact", "Blocked");
+    for (int s = 0; s < nsched; s++) {
+        for (int t = 0; t < nthread_counts; t++) {
+            omp_set_num_threads(thread_counts[t]);
+            omp_set_schedule(schedules[s].kind, schedules[s].chunk);
+
+            double t0 = omp_get_wtime();
+            double plain = 0.0;
+            #pragma omp parallel for schedule(runtime) reduction(+:plain)
+            for (size_t i = 0; i < n; i++) plain += terms[i];
+            double t1 = omp_get_wtime();
+
+            repro_acc_t acc;
+            repro_acc_init(&acc);
+            #pragma omp parallel for schedule(runtime) reduction(repro_add:acc)
+            for (size_t i = 0; i < n; i++) repro_acc_add(&acc, terms[i]);
+            double exact = repro_acc_value(&acc);
+            double t2 = omp_get_wtime();
+
+            double blocked = repro_sum_blocked(terms, n);
+            double t3 = omp_get_wtime();
+
+            plain_time += t1 - t0;
+            exact_time += t2 - t1;
+            blocked_time += t3 - t2;
+            if (configs++ == 0) {
+                first_plain = plain; first_exact = exact; first_blocked = blocked;
+            }
+            plain_differs |= plain != first_plain;
+            exact_differs |= exact != first_exact;
+            blocked_differs |= blocked != first_blocked;
+            printf("%-12s %-8d %-24.17g %-24.17g %.17g\n", schedules[s].name, thread_counts[t], plain, exact, blocked);
+        }
+    }
+    omp_set_num_threads(max_threads);
+
+    double per_elem = 1e9 / ((double)n * configs);
+    printf("Bit-identical across all %d configurations: plain %s, exact %s, blocked %s\n", configs,
+           plain_differs ? "no" : "yes", exact_differs ? "no" : "yes", blocked_differs ? "no" : "yes");
+    printf("Mean cost per term: plain %.2f ns, exact %.2f ns (%.1fx), blocked %.2f ns (%.1fx)\n",
+           plain_time * per_elem, exact_time * per_elem, exact_time / plain_time,
+           blocked_time * per_elem, blocked_time / plain_time);
+    double exact_extra = (exact_time - plain_time) * per_elem * 1e-9 * N;
+    printf("Exact mode on the %d-term workload above: ~%.1f us extra per run (%.3f%% of the sequential time)\n",
+           N, exact_extra * 1e6, workload_seconds > 0 ? exact_extra / workload_seconds * 100 : 0.0);
+    free(terms);
+}
+
+// Batch executor: many independent jobs of simulate_work iterations instead
+// of one loop. BATCH_LARGE_PERCENT of the jobs cover BATCH_LARGE_JOB
+// iterations and the rest BATCH_SMALL_JOB, each at a random offset, so the
+// per-job cost spans two orders of magnitude. The arrival rate is a
+// fraction of the capacity estimated from a serial calibration sample.
+// BATCH_JOBS, BATCH_LOAD (one fraction), BATCH_RATE (jobs/s, overrides the
+// load) and BATCH_QUEUE set the run from the environment.
+#define BATCH_SMALL_JOB 8
+#define BATCH_LARGE_JOB 256
+#define BATCH_LARGE_PERCENT 5
+#define BATCH_CALIBRATION_JOBS 200
+
+static double batch_iteration(int iteration, void *ctx) {
+    (void)ctx;
+    return simulate_work(iteration);
+}
+
+static int env_int_or(const char *name, int fallback) {
+    const char *v = getenv(name);
+    return v && atoi(v) > 0 ? atoi(v) : fallback;
+}
+
+static int run_batch_executor(void) {
+    const int njobs = env_int_or("BATCH_JOBS", 1000);
+    const int queue_capacity = env_int_or("BATCH_QUEUE", 64);
+    const char *load_env = getenv("BATCH_LOAD"), *rate_env = getenv("BATCH_RATE");
+    const uint64_t seed = dg_seed_from_env();
+    bx_job_t *jobs = (bx_job_t *)malloc(sizeof(bx_job_t) * (size_t)njobs);
+    if (!jobs) return -1;
+
+    long long total_steps = 0;
+    for (int k = 0; k < njobs; ++k) {
+        int count = (int)dg_random_below(seed, (uint64_t)k, 100) < BATCH_LARGE_PERCENT ? BATCH_LARGE_JOB : BATCH_SMALL_JOB;
+        jobs[k].id = k;
+        jobs[k].count = count;
+        jobs[k].first = (int)dg_random_below(seed + 1, (uint64_t)k, (uint32_t)(N - count + 1));
+        jobs[k].arrival = 0.0;
+        for (int i = 0; i < count; ++i) total_steps += work_amount_for(jobs[k].first + i);
+    }
+
+    // Seconds per inner step from a serial sample, scaled by the cost model
+    long long sample_steps = 0;
+    double sample_result = 0.0;
+    const int sample = njobs < BATCH_CALIBRATION_JOBS ? njobs : BATCH_CALIBRATION_JOBS;
+    double t0 = omp_get_wtime();
+    for (int k = 0; k < sample; ++k) {
+        for (int i = 0; i < jobs[k].count; ++i) {
+            sample_result += simulate_work(jobs[k].first + i);
+            sample_steps += work_amount_for(jobs[k].first + i);
+        }
+    }
+    const double mean_job = (omp_get_wtime() - t0) / (double)sample_steps * (double)total_steps / njobs;
+    const int threads = omp_get_max_threads();
+    const int cores = threads < omp_get_num_procs() ? threads : omp_get_num_procs();   // oversubscription adds none
+    const double capacity = cores / mean_job;
+    double loads[] = { 0.5, 0.9 };
+    int nloads = 2;
+    if (load_env && atof(load_env) > 0) {
+        loads[0] = atof(load_env);
+        nloads = 1;
+    }
+    if (rate_env && atof(rate_env) > 0) {
+        loads[0] = atof(rate_env) / capacity;
+        nloads = 1;
+    }
+    printf("%d jobs: %d%% of %d iterations, the rest of %d; mean job %.3f ms serial (calibrated, sample sum %.3f)\n",
+           njobs, BATCH_LARGE_PERCENT, BATCH_LARGE_JOB, BATCH_SMALL_JOB, mean_job * 1e3, sample_result);
+    printf("Estimated capacity: %.0f jobs/s (%d threads on %d core(s)); queue capacity %d\n", capacity, threads, cores,
+           queue_capacity);
+
+    bx_config_t cfg = { jobs, njobs, 0.0, queue_capacity, BATCH_LARGE_JOB, batch_iteration, NULL, seed + 2 };
+    for (int l = 0; l < nloads; ++l) {
+        cfg.rate = loads[l] * capacity;
+        printf("\nOffered load %.2f (%.0f jobs/s, Poisson arrivals)\n", loads[l], cfg.rate);
+        printf("%-10s %10s %10s %10s %10s %10s %7s %6s %s\n", "Policy", "Jobs/s", "p50 (ms)", "p99 (ms)", "p999 (ms)",
+               "Max (ms)", "Full", "Split", "Check");
+        double reference = 0.0;
+        for (int p = 0; p < BX_POLICY_COUNT; ++p) {
+            bx_report_t rep;
+            TRACE_REGION_BEGIN("part2/batch %s load %.2f", bx_policy_name((bx_policy_t)p), loads[l]);
+            int status = bx_run((bx_policy_t)p, &cfg, &rep);
+            TRACE_REGION_END();
+            if (status != 0) {
+                free(jobs);
+                return -1;
+            }
+            if (p == 0) reference = rep.checksum;
+            int ok = fabs(rep.checksum - reference) <= 1e-9 * fabs(reference);
+            printf("%-10s %10.1f %10.3f %10.3f %10.3f %10.3f %7ld %6ld %s\n", bx_policy_name((bx_policy_t)p),
+                   rep.throughput, rep.p50 * 1e3, rep.p99 * 1e3, rep.p999 * 1e3, rep.max * 1e3, rep.full_waits,
+                   rep.split_jobs, ok ? "✓" : "✗");
+        }
+    }
+    free(jobs);
+    return 0;
 }
 
 int main() {
     printf("Uneven Workload Simulation (FAST)\n");
     printf("N = %d iterations\n", N);
     printf("Threads available: %d\n", omp_get_max_threads());
-    printf("Work ~ i^2 scaled (BASE=%d, DIV=%d)\n\n", BASE_WORK, WORK_DIVISOR);
+    printf("Work ~ i^2 scaled (BASE=%d, DIV=%d)\n", BASE_WORK, WORK_DIVISOR);
+    const char *repro_env = getenv("REPRO_SUM");
+    g_repro_sum = repro_env && *repro_env && strcmp(repro_env, "0") != 0;
+    printf("Total results: %s\n\n", g_repro_sum ? "reproducible (exact superaccumulator)" : "plain reduction (set REPRO_SUM=1 for bit-identical totals)");
 
     int static_chunks[]  = {0, 256};
     int dynamic_chunks[] = {1, 64};
     int guided_chunks[]  = {1, 64};
+    int worksteal_chunks[] = {1, 64};
 
     printf("===== STATIC =====\n");
     for (size_t i = 0; i < sizeof(static_chunks)/sizeof(static_chunks[0]); ++i) {
@@ -120,14 +584,41 @@ int main() {
         run_guided(guided_chunks[i]);
     }
 
+    printf("\n===== WORK STEALING =====\n");
+    for (size_t i = 0; i < sizeof(worksteal_chunks)/sizeof(worksteal_chunks[0]); ++i) {
+        run_worksteal(worksteal_chunks[i]);
+    }
+
+    printf("\n===== WEIGHTED STATIC =====\n");
+    run_weighted_static();
+    wp_adaptive_t adaptive_model = {0};
+    for (int pass = 0; pass < 2; ++pass) {
+        run_weighted_adaptive(&adaptive_model);
+    }
+    wp_adaptive_free(&adaptive_model);
+
+    printf("\n===== AUTOTUNED SCHEDULE =====\n");
+    run_autotuned();
+
+    printf("\n===== BATCH EXECUTOR =====\n");
+    if (run_batch_executor() != 0) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+
     // Sequential baseline for reference
     printf("\n===== SEQUENTIAL (baseline) =====\n");
     double seq_start = omp_get_wtime();
-    double seq_total = 0.0;
-    for (int i = 0; i < N; ++i) seq_total += simulate_work(i);
+    result_acc_t seq_total;
+    result_acc_init(&seq_total);
+    for (int i = 0; i < N; ++i) result_acc_add(&seq_total, simulate_work(i));
     double seq_end = omp_get_wtime();
     printf("Sequential time: %.6f s\n", seq_end - seq_start);
-    printf("Sequential result: %.6f\n", seq_total);
+    if (g_repro_sum) printf("Sequential result: %.17g (reproducible)\n", repro_acc_value(&seq_total.exact));
+    else printf("Sequential result: %.6f\n", seq_total.plain);
+
+    printf("\n===== REPRODUCIBLE SUMMATION =====\n");
+    run_repro_comparison(seq_end - seq_start);
 
     return 0;
 }
@@ -1,59 +1,546 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include <omp.h>
-#include <time.h>
+#include "agg_index.h"
+#include "compact_column.h"
+#include "dataset_io.h"
+#include "datagen.h"
+#include "even_count.h"
+#include "fused_agg.h"
+#include "numa_alloc.h"
+#include "perf_counters.h"
+#include "reduce_engine.h"
+#include "shard_counter.h"
+#include "trace.h"
 
 #define ARRAY_SIZE 10000000
+#define FUSED_TRIALS 3
+#define HIST_BINS 1000   // one bin per value of the 0..999 data
+#define COMPACT_TRIALS 3
+#define INDEX_ROUNDS 100
+
+// One counting-engine variant; `fn == NULL` means "query the parity sidecar".
+typedef struct {
+    char name[32];
+    even_count_fn fn;
+} engine_variant_t;
+
+static long long engine_count(const engine_variant_t *v, const int *array, const parity_sidecar_t *ps,
+                              size_t lo, size_t hi) {
+    return v->fn ? v->fn(array + lo, hi - lo) : parity_sidecar_count_even(ps, lo, hi);
+}
+
+static int engine_variants(engine_variant_t *out) {
+    int n = 0;
+    snprintf(out[n].name, sizeof(out[n].name), "branchy (%% 2)");
+    out[n++].fn = even_count_branchy;
+    snprintf(out[n].name, sizeof(out[n].name), "branch-free");
+    out[n++].fn = even_count_branchfree;
+    for (int k = ISA_SSE2; k < ISA_COUNT; ++k) {
+        if (!simd_isa_supported((simd_isa_t)k)) continue;
+        snprintf(out[n].name, sizeof(out[n].name), "simd %s", simd_isa_name((simd_isa_t)k));
+        out[n++].fn = even_count_simd_for((simd_isa_t)k);
+    }
+    snprintf(out[n].name, sizeof(out[n].name), "parity sidecar");
+    out[n++].fn = NULL;
+    return n;
+}
+
+// Every engine variant against the `% 2` loop on inputs chosen to break
+// parity shortcuts: negative values (including INT_MIN), all-even, all-odd,
+// and lengths that leave partial vectors and partial sidecar words.
+static int engine_self_check(void) {
+    static const size_t lengths[] = {0, 1, 15, 17, 63, 64, 65, 129, 1037};
+    const size_t max_len = 1037;
+    int *data = (int *)malloc(sizeof(int) * max_len);
+    engine_variant_t variants[ISA_COUNT + 3];
+    int nv = engine_variants(variants);
+    int failures = 0;
+    if (!data) return -1;
+
+    for (int pattern = 0; pattern < 4; ++pattern) {
+        for (size_t i = 0; i < max_len; ++i) {
+            switch (pattern) {
+                case 0: data[i] = (int)(i * 2654435761u) | (int)0x80000000; break;      // all negative
+                case 1: data[i] = ((int)(i * 40503u) - 20000) * 2; break;               // all even
+                case 2: data[i] = ((int)(i * 40503u) - 20000) * 2 + 1; break;           // all odd
+                default: data[i] = (i % 3 == 0) ? -(int)i : (i % 3 == 1) ? INT_MIN + (int)i : INT_MAX - (int)i;
+            }
+        }
+        if (pattern == 0) data[0] = INT_MIN;
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+            size_t len = lengths[l];
+            long long expected = even_count_branchy(data, len);
+            parity_sidecar_t ps;
+            if (parity_sidecar_build(&ps, data, len) != 0) { free(data); return -1; }
+            for (int v = 0; v < nv; ++v) {
+                long long got = engine_count(&variants[v], data, &ps, 0, len);
+                // also a sub-range that starts and ends mid-word
+                size_t lo = len / 3, hi = len - len / 5;
+                long long sub_expected = even_count_branchy(data + lo, hi - lo);
+                long long sub_got = engine_count(&variants[v], data, &ps, lo, hi);
+                if (got != expected || sub_got != sub_expected) {
+                    printf("✗ %s: pattern %d, length %zu -> %lld (expected %lld), [%zu,%zu) -> %lld (expected %lld)\n",
+                           variants[v].name, pattern, len, got, expected, lo, hi, sub_got, sub_expected);
+                    failures++;
+                }
+            }
+            parity_sidecar_free(&ps);
+        }
+    }
+    free(data);
+    return failures;
+}
+
+// Runs one variant the three ways the main comparison does: one thread over
+// the whole array, per-thread partial counts merged in a critical section,
+// and per-thread partial counts merged by an OpenMP reduction.
+static void run_engine_variant(const engine_variant_t *v, const int *array, const parity_sidecar_t *ps,
+                               long array_size, long long expected) {
+    size_t n = (size_t)array_size;
+    long long seq = 0, crit = 0, red = 0;
+    double t0, seq_time, crit_time, red_time;
+    static perf_sample_t seq_counters, crit_counters, red_counters;
+
+    perf_begin_serial(&seq_counters);
+    t0 = omp_get_wtime();
+    seq = engine_count(v, array, ps, 0, n);
+    seq_time = omp_get_wtime() - t0;
+    perf_end(&seq_counters);
+
+    perf_begin(&crit_counters);
+    t0 = omp_get_wtime();
+    TRACE_REGION_BEGIN("part3/%s critical", v->name);
+    #pragma omp parallel
+    {
+        size_t lo, hi;
+        static_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+        long long local = engine_count(v, array, ps, lo, hi);
+        #pragma omp critical
+        {
+            crit += local;
+        }
+    }
+    TRACE_REGION_END();
+    crit_time = omp_get_wtime() - t0;
+    perf_end(&crit_counters);
+
+    perf_begin(&red_counters);
+    t0 = omp_get_wtime();
+    TRACE_REGION_BEGIN("part3/%s reduction", v->name);
+    #pragma omp parallel reduction(+:red)
+    {
+        size_t lo, hi;
+        static_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+        red += engine_count(v, array, ps, lo, hi);
+    }
+    TRACE_REGION_END();
+    red_time = omp_get_wtime() - t0;
+    perf_end(&red_counters);
+
+    printf("%-16s %10.6f %9.1f %10.6f %9.1f %10.6f %9.1f %s\n", v->name,
+           seq_time, array_size / seq_time / 1e6, crit_time, array_size / crit_time / 1e6,
+           red_time, array_size / red_time / 1e6,
+           (seq == expected && crit == expected && red == expected) ? "✓" : "✗");
+    perf_print_row("seq", &seq_counters, (double)array_size);
+    perf_print_row("crit", &crit_counters, (double)array_size);
+    perf_print_row("red", &red_counters, (double)array_size);
+}
+
+static void print_aggregation_row(const char *name, double seconds, long array_size, long long count,
+                                  long long expected) {
+    printf("%-22s %10.6f %9.1f %s\n", name, seconds, array_size / seconds / 1e6, count == expected ? "✓" : "✗");
+}
+
+// The per-element update of the critical-section loop, made without a
+// lock: the engine's atomic strategy and each shard_counter.h primitive.
+// The tree merge counts into a private local first and combines once per
+// thread.
+static void run_aggregation_modes(const int *array, long array_size, long long expected) {
+    double t0;
+    long long count = 0;
+
+    t0 = omp_get_wtime();
+    TRACE_REGION_BEGIN("part3/agg atomic");
+    re_count_i32(array, (size_t)array_size, RE_ATOMIC, &count);
+    TRACE_REGION_END();
+    print_aggregation_row("per-element atomic", omp_get_wtime() - t0, array_size, count, expected);
+
+    sc_sharded_t *sharded = (sc_sharded_t *)aligned_alloc(SC_CACHE_LINE, sizeof(sc_sharded_t));
+    if (sharded) {
+        sc_sharded_init(sharded);
+        t0 = omp_get_wtime();
+        TRACE_REGION_BEGIN("part3/agg sharded");
+        #pragma omp parallel
+        {
+            int tid = omp_get_thread_num();
+            #pragma omp for schedule(static)
+            for (long i = 0; i < array_size; i++) {
+                if (array[i] % 2 == 0) sc_sharded_add(sharded, tid, 1);
+            }
+        }
+        TRACE_REGION_END();
+        print_aggregation_row("per-element sharded", omp_get_wtime() - t0, array_size, sc_sharded_total(sharded),
+                              expected);
+        free(sharded);
+    }
+
+    for (int padded = 0; padded <= 1; ++padded) {
+        sc_slots_t slots;
+        if (sc_slots_init(&slots, omp_get_max_threads(), padded) != 0) continue;
+        t0 = omp_get_wtime();
+        TRACE_REGION_BEGIN("part3/agg %s slots", padded ? "padded" : "unpadded");
+        #pragma omp parallel
+        {
+            int tid = omp_get_thread_num();
+            #pragma omp for schedule(static)
+            for (long i = 0; i < array_size; i++) {
+                if (array[i] % 2 == 0) sc_slots_add(&slots, tid, 1);
+            }
+        }
+        TRACE_REGION_END();
+        print_aggregation_row(padded ? "per-element padded" : "per-element unpadded", omp_get_wtime() - t0,
+                              array_size, sc_slots_total(&slots), expected);
+        sc_slots_free(&slots);
+    }
+
+    t0 = omp_get_wtime();
+    TRACE_REGION_BEGIN("part3/agg tree merge");
+    int status = re_count_i32(array, (size_t)array_size, RE_TREE, &count);
+    TRACE_REGION_END();
+    if (status == 0) print_aggregation_row("local + tree merge", omp_get_wtime() - t0, array_size, count, expected);
+}
+
+// Streaming mode: the reduction loop below runs unchanged on each block
+// while the next block is read in the background.
+static void count_block(const void *block, size_t count, uint32_t elem_size, void *ctx) {
+    long long block_count = 0;
+    long n = (long)count;
+    TRACE_REGION_BEGIN("part3/stream block");
+    if (elem_size == 4) {
+        const int *array = (const int *)block;
+        #pragma omp parallel for reduction(+:block_count) schedule(static)
+        for (long i = 0; i < n; i++) {
+            if (array[i] % 2 == 0) {
+                block_count++;
+            }
+        }
+    } else {
+        const long long *array = (const long long *)block;
+        #pragma omp parallel for reduction(+:block_count) schedule(static)
+        for (long i = 0; i < n; i++) {
+            if (array[i] % 2 == 0) {
+                block_count++;
+            }
+        }
+    }
+    TRACE_REGION_END();
+    *(long long *)ctx += block_count;
+}
+
+static int run_streaming(const char *path) {
+    long long stream_count = 0;
+    dataset_header_t hdr;
+    dataset_stream_stats_t stats;
+    
+    printf("=== STREAMING REDUCTION (%s) ===\n", path);
+    if (dataset_stream(path, DATASET_CHUNK_ELEMS, count_block, &stream_count, &hdr, &stats) != 0) return 1;
+    printf("Elements: %llu x int%u, %d threads\n", (unsigned long long)hdr.count, hdr.elem_size * 8, omp_get_max_threads());
+    printf("Streamed count: %lld even numbers\n", stream_count);
+    dataset_stream_report(&stats);
+    return 0;
+}
+
+// Aggregates one by one through the engine (one DRAM pass each) against
+// one fused cache-blocked pass. FUSED_OPS=sum,count_even,min,max,histogram
+// picks the set; unset means all of them. Best of FUSED_TRIALS each.
+static int run_fused_comparison(const int *array, long array_size) {
+    const unsigned ops = fa_parse_ops(getenv("FUSED_OPS"));
+    const re_hist_spec_t spec = { HIST_BINS, 0.0, (double)HIST_BINS };
+    const double pass_bytes = (double)array_size * sizeof(int);
+    long long *bins = (long long *)malloc(sizeof(long long) * HIST_BINS);
+    long long *fused_bins = (long long *)malloc(sizeof(long long) * HIST_BINS);
+    if (!bins || !fused_bins || ops == 0) {
+        free(bins); free(fused_bins);
+        return ops == 0 ? 0 : -1;
+    }
+
+    printf("%-22s %10s %10s %9s\n", "Aggregate", "Time (s)", "MB moved", "GB/s");
+    fa_result_t separate = { 0, 0, 0, 0, bins };
+    double separate_time = 0.0;
+    for (unsigned op = 1; op < FA_ALL; op <<= 1) {
+        if (!(ops & op)) continue;
+        double best = 1e100;
+        for (int t = 0; t < FUSED_TRIALS; ++t) {
+            double t0 = omp_get_wtime();
+            TRACE_REGION_BEGIN("part3/separate %s", fa_op_name(op));
+            switch (op) {
+            case FA_SUM: re_sum_i32(array, (size_t)array_size, RE_REDUCTION, &separate.sum); break;
+            case FA_COUNT_EVEN: re_count_i32(array, (size_t)array_size, RE_REDUCTION, &separate.even); break;
+            case FA_MIN: re_min_i32(array, (size_t)array_size, RE_REDUCTION, &separate.min); break;
+            case FA_MAX: re_max_i32(array, (size_t)array_size, RE_REDUCTION, &separate.max); break;
+            default: re_hist_i32(array, (size_t)array_size, RE_REDUCTION, &spec, bins); break;
+            }
+            TRACE_REGION_END();
+            double elapsed = omp_get_wtime() - t0;
+            if (elapsed < best) best = elapsed;
+        }
+        separate_time += best;
+        printf("%-22s %10.6f %10.1f %9.2f\n", fa_op_name(op), best, pass_bytes / 1e6, pass_bytes / best / 1e9);
+    }
+
+    fa_result_t fused = { 0, 0, 0, 0, fused_bins };
+    double fused_time = 1e100;
+    for (int t = 0; t < FUSED_TRIALS; ++t) {
+        double t0 = omp_get_wtime();
+        TRACE_REGION_BEGIN("part3/fused");
+        int status = fa_aggregate_i32(array, (size_t)array_size, ops, &spec, &fused);
+        TRACE_REGION_END();
+        double elapsed = omp_get_wtime() - t0;
+        if (status != 0) {
+            free(bins); free(fused_bins);
+            return -1;
+        }
+        if (elapsed < fused_time) fused_time = elapsed;
+    }
+
+    int nops = fa_op_count(ops);
+    int ok = (!(ops & FA_SUM) || fused.sum == separate.sum) && (!(ops & FA_COUNT_EVEN) || fused.even == separate.even) &&
+             (!(ops & FA_MIN) || fused.min == separate.min) && (!(ops & FA_MAX) || fused.max == separate.max) &&
+             (!(ops & FA_HISTOGRAM) || memcmp(bins, fused_bins, sizeof(long long) * HIST_BINS) == 0);
+    printf("%-22s %10.6f %10.1f %9.2f\n", "separate (total)", separate_time, nops * pass_bytes / 1e6,
+           nops * pass_bytes / separate_time / 1e9);
+    printf("%-22s %10.6f %10.1f %9.2f %s\n", "fused (one pass)", fused_time, pass_bytes / 1e6,
+           pass_bytes / fused_time / 1e9, ok ? "✓" : "✗");
+    printf("Fused speedup: %.2fx for %d aggregate(s); DRAM traffic cut %dx (%d KB blocks)\n",
+           separate_time / fused_time, nops, nops, (int)(FA_BLOCK * sizeof(int) / 1024));
+    free(bins);
+    free(fused_bins);
+    return 0;
+}
+
+// Even count over each compact layout against the int32 array. Values
+// 0-999 need 10 bits, so the packed layout scans under a third of the
+// bytes. Best of COMPACT_TRIALS each; encoding time is reported apart.
+static int run_compact_comparison(const int *array, long array_size, long long expected) {
+    const cc_encoding_t layouts[] = { CC_U16, CC_PACKED, CC_FOR };
+    const double raw_bytes = (double)array_size * sizeof(int);
+    cc_column_t probe;
+    if (cc_encode(&probe, array, (size_t)array_size, CC_AUTO) != 0) {
+        cc_free(&probe);
+        return -1;
+    }
+    printf("Auto layout: %s (%d-bit offsets from base %d)\n", cc_encoding_name(probe.encoding), probe.width, probe.base);
+    cc_free(&probe);
+
+    printf("%-8s %8s %7s %10s %10s %9s %8s\n", "Layout", "MB", "Ratio", "Encode (s)", "Time (s)", "GB/s", "Speedup");
+    double int_time = 1e100;
+    long long count = 0;
+    for (int t = 0; t < COMPACT_TRIALS; ++t) {
+        double t0 = omp_get_wtime();
+        re_count_i32(array, (size_t)array_size, RE_REDUCTION, &count);
+        double elapsed = omp_get_wtime() - t0;
+        if (elapsed < int_time) int_time = elapsed;
+    }
+    printf("%-8s %8.1f %6.2fx %10s %10.6f %9.2f %7.2fx %s\n", "int32", raw_bytes / 1e6, 1.0, "-", int_time,
+           raw_bytes / int_time / 1e9, 1.0, count == expected ? "✓" : "✗");
+
+    for (int l = 0; l < (int)(sizeof(layouts) / sizeof(layouts[0])); ++l) {
+        cc_column_t col;
+        double t0 = omp_get_wtime();
+        if (cc_encode(&col, array, (size_t)array_size, layouts[l]) != 0) {
+            cc_free(&col);
+            return -1;
+        }
+        double encode_time = omp_get_wtime() - t0;
+        double best = 1e100;
+        for (int t = 0; t < COMPACT_TRIALS; ++t) {
+            t0 = omp_get_wtime();
+            TRACE_REGION_BEGIN("part3/compact %s", cc_encoding_name(col.encoding));
+            count = cc_count_even(&col);
+            TRACE_REGION_END();
+            double elapsed = omp_get_wtime() - t0;
+            if (elapsed < best) best = elapsed;
+        }
+        double bytes = (double)cc_bytes(&col);
+        printf("%-8s %8.1f %6.2fx %10.6f %10.6f %9.2f %7.2fx %s\n", cc_encoding_name(col.encoding), bytes / 1e6,
+               raw_bytes / bytes, encode_time, best, bytes / best / 1e9, int_time / best, count == expected ? "✓" : "✗");
+        cc_free(&col);
+    }
+    return 0;
+}
+
+// Mixed workload: each round writes `rate` random elements, then asks for
+// the even count of a random range covering at least half the array. The
+// full scan answers with the reduction loop; the index answers from its
+// trees after eager per-element updates or one lazy batch. Only the update
+// and query work is timed; every method starts from the same array.
+static int run_incremental_comparison(const int *array, long array_size, uint64_t seed) {
+    const size_t rates[] = { 1, 16, 256, 4096, 65536 };
+    const size_t n = (size_t)array_size;
+    const size_t max_rate = rates[sizeof(rates) / sizeof(rates[0]) - 1];
+    int *work = (int *)malloc(sizeof(int) * n);
+    size_t *idx = (size_t *)malloc(sizeof(size_t) * max_rate);
+    int *values = (int *)malloc(sizeof(int) * max_rate);
+    if (!work || !idx || !values) {
+        free(work); free(idx); free(values);
+        return -1;
+    }
+
+    printf("%d rounds of <rate> updates + 1 range query; time per round\n", INDEX_ROUNDS);
+    printf("%-8s %12s %12s %12s %9s %9s %s\n", "Rate", "Scan (us)", "Eager (us)", "Batch (us)", "Eager x", "Batch x",
+           "Check");
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+        const size_t rate = rates[r];
+        double elapsed[3];
+        long long checksum[3], final_sum[3];
+        for (int method = 0; method < 3; ++method) {
+            ai_index_t ix;
+            memcpy(work, array, sizeof(int) * n);
+            if (method > 0 && ai_build(&ix, work, n) != 0) {
+                free(work); free(idx); free(values);
+                return -1;
+            }
+            elapsed[method] = 0.0;
+            checksum[method] = 0;
+            for (int round = 0; round < INDEX_ROUNDS; ++round) {
+                const uint64_t base = (uint64_t)round * max_rate;
+                for (size_t k = 0; k < rate; ++k) {
+                    idx[k] = (size_t)dg_random_below64(seed + 1, base + k, n);
+                    values[k] = (int)dg_random_below(seed + 2, base + k, 1000);
+                }
+                const size_t lo = (size_t)dg_random_below64(seed + 3, (uint64_t)round, n / 4 + 1);
+                const size_t hi = n - (size_t)dg_random_below64(seed + 4, (uint64_t)round, n / 4 + 1);
+                long long count = 0;
+
+                double t0 = omp_get_wtime();
+                TRACE_REGION_BEGIN("part3/incremental m%d rate %zu", method, rate);
+                if (method == 0) {
+                    for (size_t k = 0; k < rate; ++k) work[idx[k]] = values[k];
+                    re_count_i32(work + lo, hi - lo, RE_REDUCTION, &count);
+                } else if (method == 1) {
+                    for (size_t k = 0; k < rate; ++k) ai_update(&ix, idx[k], values[k]);
+                    count = ai_range_even(&ix, lo, hi);
+                } else {
+                    ai_update_batch(&ix, idx, values, rate);
+                    count = ai_range_even(&ix, lo, hi);
+                }
+                TRACE_REGION_END();
+                elapsed[method] += omp_get_wtime() - t0;
+                checksum[method] += count;
+            }
+            if (method == 0) re_sum_i32(work, n, RE_REDUCTION, &final_sum[0]);
+            else {
+                final_sum[method] = ai_range_sum(&ix, 0, n);
+                ai_free(&ix);
+            }
+        }
+        int ok = checksum[1] == checksum[0] && checksum[2] == checksum[0] && final_sum[1] == final_sum[0] &&
+                 final_sum[2] == final_sum[0];
+        printf("%-8zu %12.2f %12.2f %12.2f %8.1fx %8.1fx %s\n", rate, elapsed[0] / INDEX_ROUNDS * 1e6,
+               elapsed[1] / INDEX_ROUNDS * 1e6, elapsed[2] / INDEX_ROUNDS * 1e6, elapsed[0] / elapsed[1],
+               elapsed[0] / elapsed[2], ok ? "✓" : "✗");
+    }
+    printf("Index: %d-element blocks, %zu blocks, %.1f KB beside the %.1f MB array\n", AI_BLOCK,
+           (n + AI_BLOCK - 1) / AI_BLOCK, (n + AI_BLOCK - 1) / AI_BLOCK * (4 * sizeof(long long) + 1) / 1e3,
+           n * sizeof(int) / 1e6);
+    free(work);
+    free(idx);
+    free(values);
+    return 0;
+}
 
 int main() {
+    numa_array_t storage = {0};
+    dataset_t dataset = {0};
+    const char *dataset_path = getenv("DATASET");
+    const char *dataset_mode = getenv("DATASET_MODE");
+    long array_size = ARRAY_SIZE;
     int *array;
-    int sequential_count = 0;
-    int parallel_count_critical = 0;
-    int parallel_count_reduction = 0;
-    double start_time, end_time;
+    long long sequential_count = 0;
+    long long parallel_count_critical = 0;
+    long long parallel_count_reduction = 0;
+    double start_time, end_time, setup_time = 0.0;
+    uint64_t seed = dg_seed_from_env();
     double sequential_time, critical_time, reduction_time;
     
-    // Allocate memory for array
-    array = (int *)malloc(ARRAY_SIZE * sizeof(int));
-    if (array == NULL) {
-        printf("Memory allocation failed!\n");
-        return 1;
+    // DATASET=<file> replaces the generated array with a file written by
+    // make_dataset; DATASET_MODE=stream reads it in blocks instead of mapping it
+    if (dataset_path && dataset_mode && strcmp(dataset_mode, "stream") == 0) {
+        return run_streaming(dataset_path);
     }
     
-    // Initialize array with random integers
-    srand(time(NULL));
-    for (int i = 0; i < ARRAY_SIZE; i++) {
-        array[i] = rand() % 1000; // Random numbers 0-999
+    if (dataset_path) {
+        if (dataset_map(dataset_path, &dataset) != 0) return 1;
+        if (dataset.header.elem_size != sizeof(int)) {
+            printf("%s holds int64 elements; run it with DATASET_MODE=stream\n", dataset_path);
+            dataset_unmap(&dataset);
+            return 1;
+        }
+        array = (int *)dataset.data;
+        array_size = (long)dataset.header.count;
+    } else {
+        double setup_start = omp_get_wtime();
+        // Allocate memory for array
+        if (numa_array_alloc(&storage, ARRAY_SIZE) != 0) {
+            printf("Memory allocation failed!\n");
+            return 1;
+        }
+        array = storage.data;
+        
+        // Random integers 0-999 from a counter-based generator: reproducible
+        // from DATA_SEED for any thread count, and filled with the static
+        // partition the counting loops use (first touch)
+        TRACE_REGION_BEGIN("part3/init");
+        dg_fill_uniform(array, ARRAY_SIZE, 1000, seed);
+        TRACE_REGION_END();
+        setup_time = omp_get_wtime() - setup_start;
     }
     
     printf("Even Number Counting - Race Condition Analysis\n");
-    printf("Array size: %d elements\n", ARRAY_SIZE);
+    printf("Array size: %ld elements\n", array_size);
     printf("Number of threads: %d\n", omp_get_max_threads());
+    if (!dataset_path) {
+        printf("Data: uniform 0-999, DATA_SEED=%llu; setup time (allocation + generation): %f seconds\n",
+               (unsigned long long)seed, setup_time);
+    }
+    perf_print_status();
+    if (dataset_path) {
+        printf("Input: %s (mmap, MADV_SEQUENTIAL)\n", dataset_path);
+    } else {
+        TRACE_REGION_BEGIN("part3/placement report");
+        numa_report(&storage);
+        TRACE_REGION_END();
+    }
     printf("\n");
     
     // SEQUENTIAL VERSION
     printf("=== SEQUENTIAL VERSION ===\n");
+    perf_sample_t counters;
+    perf_begin_serial(&counters);
     start_time = omp_get_wtime();
     
-    for (int i = 0; i < ARRAY_SIZE; i++) {
-        if (array[i] % 2 == 0) {
-            sequential_count++;
-        }
-    }
+    re_count_i32(array, (size_t)array_size, RE_SEQUENTIAL, &sequential_count);
     
     end_time = omp_get_wtime();
+    perf_end(&counters);
     sequential_time = end_time - start_time;
     
-    printf("Sequential count: %d even numbers\n", sequential_count);
+    printf("Sequential count: %lld even numbers\n", sequential_count);
     printf("Sequential time: %f seconds\n", sequential_time);
+    perf_print_row("counters", &counters, (double)array_size);
     printf("\n");
     
     // PARALLEL VERSION WITH CRITICAL SECTION
     printf("=== PARALLEL VERSION WITH CRITICAL SECTION ===\n");
+    perf_begin(&counters);
     start_time = omp_get_wtime();
     
-    #pragma omp parallel for
-    for (int i = 0; i < ARRAY_SIZE; i++) {
+    TRACE_REGION_BEGIN("part3/critical");
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < array_size; i++) {
         if (array[i] % 2 == 0) {
             #pragma omp critical
             {
@@ -61,30 +548,100 @@ int main() {
             }
         }
     }
+    TRACE_REGION_END();
     
     end_time = omp_get_wtime();
+    perf_end(&counters);
     critical_time = end_time - start_time;
     
-    printf("Parallel count (critical): %d even numbers\n", parallel_count_critical);
+    printf("Parallel count (critical): %lld even numbers\n", parallel_count_critical);
     printf("Parallel time (critical): %f seconds\n", critical_time);
+    perf_print_row("counters", &counters, (double)array_size);
     printf("\n");
     
     // PARALLEL VERSION WITH REDUCTION
     printf("=== PARALLEL VERSION WITH REDUCTION ===\n");
+    perf_begin(&counters);
     start_time = omp_get_wtime();
     
-    #pragma omp parallel for reduction(+:parallel_count_reduction)
-    for (int i = 0; i < ARRAY_SIZE; i++) {
-        if (array[i] % 2 == 0) {
-            parallel_count_reduction++;
-        }
-    }
+    TRACE_REGION_BEGIN("part3/reduction");
+    re_count_i32(array, (size_t)array_size, RE_REDUCTION, &parallel_count_reduction);
+    TRACE_REGION_END();
     
     end_time = omp_get_wtime();
+    perf_end(&counters);
     reduction_time = end_time - start_time;
     
-    printf("Parallel count (reduction): %d even numbers\n", parallel_count_reduction);
+    printf("Parallel count (reduction): %lld even numbers\n", parallel_count_reduction);
     printf("Parallel time (reduction): %f seconds\n", reduction_time);
+    perf_print_row("counters", &counters, (double)array_size);
+    printf("\n");
+    
+    // COUNTING ENGINE
+    printf("=== EVEN-COUNTING ENGINE ===\n");
+    TRACE_REGION_BEGIN("part3/engine self-check");
+    int check_failures = engine_self_check();
+    TRACE_REGION_END();
+    if (check_failures == 0) {
+        printf("✓ Engine self-check passed (negative, all-even, all-odd, ragged lengths)\n");
+    } else {
+        printf("✗ Engine self-check: %d mismatches\n", check_failures);
+    }
+    
+    parity_sidecar_t sidecar;
+    start_time = omp_get_wtime();
+    TRACE_REGION_BEGIN("part3/sidecar build");
+    if (parity_sidecar_build(&sidecar, array, (size_t)array_size) != 0) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+    TRACE_REGION_END();
+    end_time = omp_get_wtime();
+    printf("Parity sidecar: %zu KB (array: %zu KB), built in %f seconds\n",
+           sidecar.words * sizeof(uint64_t) / 1024, (size_t)array_size * sizeof(int) / 1024, end_time - start_time);
+    
+    engine_variant_t variants[ISA_COUNT + 3];
+    int variant_count = engine_variants(variants);
+    printf("%-16s %10s %9s %10s %9s %10s %9s\n", "Variant", "Seq (s)", "Melem/s",
+           "Crit (s)", "Melem/s", "Red (s)", "Melem/s");
+    for (int v = 0; v < variant_count; ++v) {
+        run_engine_variant(&variants[v], array, &sidecar, array_size, sequential_count);
+    }
+    parity_sidecar_free(&sidecar);
+    printf("\n");
+    
+    // CONCURRENT AGGREGATION
+    // Lock-free replacements for the critical-section update; the padded /
+    // unpadded pair differs only in slot layout (false sharing).
+    printf("=== CONCURRENT AGGREGATION ===\n");
+    printf("%-22s %10s %9s\n", "Mode", "Time (s)", "Melem/s");
+    print_aggregation_row("per-element critical", critical_time, array_size, parallel_count_critical, sequential_count);
+    run_aggregation_modes(array, array_size, sequential_count);
+    print_aggregation_row("reduction", reduction_time, array_size, parallel_count_reduction, sequential_count);
+    printf("\n");
+    
+    // FUSED AGGREGATES
+    printf("=== FUSED AGGREGATES ===\n");
+    if (run_fused_comparison(array, array_size) != 0) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+    printf("\n");
+    
+    // COMPACT STORAGE
+    printf("=== COMPACT STORAGE ===\n");
+    if (run_compact_comparison(array, array_size, sequential_count) != 0) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+    printf("\n");
+    
+    // INCREMENTAL AGGREGATES
+    printf("=== INCREMENTAL AGGREGATES ===\n");
+    if (run_incremental_comparison(array, array_size, seed) != 0) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
     printf("\n");
     
     // PERFORMANCE ANALYSIS
@@ -123,7 +680,7 @@ int main() {
         printf("✓ All results are correct and consistent\n");
     } else {
         printf("✗ Results are inconsistent!\n");
-        printf("Sequential: %d, Critical: %d, Reduction: %d\n",
+        printf("Sequential: %lld, Critical: %lld, Reduction: %lld\n",
                sequential_count, parallel_count_critical, parallel_count_reduction);
     }
     
@@ -146,21 +703,23 @@ int main() {
     printf("=== RACE CONDITION DEMONSTRATION ===\n");
     printf("Running unsafe parallel version (with race condition)...\n");
     
-    int unsafe_count = 0;
+    long long unsafe_count = 0;
     start_time = omp_get_wtime();
     
-    #pragma omp parallel for
-    for (int i = 0; i < ARRAY_SIZE; i++) {
+    TRACE_REGION_BEGIN("part3/unsafe");
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < array_size; i++) {
         if (array[i] % 2 == 0) {
             unsafe_count++; // Race condition here!
         }
     }
+    TRACE_REGION_END();
     
     end_time = omp_get_wtime();
     
-    printf("Unsafe count: %d even numbers\n", unsafe_count);
+    printf("Unsafe count: %lld even numbers\n", unsafe_count);
     printf("Unsafe time: %f seconds\n", end_time - start_time);
-    printf("Expected count: %d even numbers\n", sequential_count);
+    printf("Expected count: %lld even numbers\n", sequential_count);
     
     if (unsafe_count != sequential_count) {
         printf("✗ Race condition detected! Count is incorrect.\n");
@@ -168,6 +727,10 @@ int main() {
         printf("⚠ Race condition may not have manifested in this run.\n");
     }
     
-    free(array);
+    if (dataset_path) {
+        dataset_unmap(&dataset);
+    } else {
+        numa_array_free(&storage);
+    }
     return 0;
 }
\ No newline at end of file
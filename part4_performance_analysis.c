@@ -1,15 +1,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <omp.h>
+#include "bench_harness.h"
+#include "compact_column.h"
+#include "datagen.h"
+#include "numa_alloc.h"
+#include "perf_counters.h"
+#include "reduce_engine.h"
+#include "scaling_model.h"
+#include "stream_peak.h"
+#include "thread_pool.h"
+#include "trace.h"
 
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE 50000000
 #endif
-#ifndef TRIALS
-#define TRIALS 3                 // run each config multiple times; keep the best time
-#endif
 
+static numa_array_t g_storage;
 static int *g_array = NULL;
+static double g_setup_time = 0.0;
 static const int MODVAL = 1000;   // values are i % MODVAL
 
 static long long expected_sum(long long n) {
@@ -21,70 +30,552 @@ static long long expected_sum(long long n) {
     return cycles * cycle_sum + rem_sum;
 }
 
+// First touch with the full team and schedule(static): at the maximum
+// thread count every thread reads pages on its own node. Smaller teams in
+// the sweep still span all nodes, so they see the aggregate bandwidth of
+// the machine rather than only socket 0's.
 static void init_array_once() {
     if (!g_array) {
-        g_array = (int *)malloc(sizeof(int) * (size_t)ARRAY_SIZE);
-        if (!g_array) { fprintf(stderr, "Memory allocation failed!\n"); exit(1); }
-        for (int i = 0; i < ARRAY_SIZE; ++i) g_array[i] = i % MODVAL;
+        double t0 = omp_get_wtime();
+        if (numa_array_alloc(&g_storage, (size_t)ARRAY_SIZE) != 0) { fprintf(stderr, "Memory allocation failed!\n"); exit(1); }
+        g_array = g_storage.data;
+        TRACE_REGION_BEGIN("part4/init");
+        dg_fill_mod(g_array, ARRAY_SIZE, MODVAL, 0);
+        TRACE_REGION_END();
+        g_setup_time = omp_get_wtime() - t0;
     }
 }
 
-static double run_sequential(long long *sum_out) {
-    long long sum = 0;
-    double best = 1e100;
-    for (int t = 0; t < TRIALS; ++t) {
-        double t0 = omp_get_wtime();
-        for (int i = 0; i < ARRAY_SIZE; ++i) sum += g_array[i];
-        double t1 = omp_get_wtime();
-        if (t1 - t0 < best) best = t1 - t0;
-        sum = 0; // reset between trials to be fair
-    }
-    // one final pass to get the displayed sum
-    for (int i = 0; i < ARRAY_SIZE; ++i) sum += g_array[i];
-    if (sum_out) *sum_out = sum;
-    return best;
+typedef struct {
+    int requested_threads;
+    int actual_threads;
+    long long sum;
+} reduce_ctx_t;
+
+// The sum is stored through ctx so the compiler cannot discard the pass.
+static void sequential_pass(void *arg) {
+    reduce_ctx_t *ctx = (reduce_ctx_t *)arg;
+    re_sum_i32(g_array, ARRAY_SIZE, RE_SEQUENTIAL, &ctx->sum);
+}
+
+static void parallel_pass(void *arg) {
+    reduce_ctx_t *ctx = (reduce_ctx_t *)arg;
+    TRACE_REGION_BEGIN("part4/reduction %d threads", ctx->requested_threads);
+    re_sum_i32(g_array, ARRAY_SIZE, RE_REDUCTION, &ctx->sum);
+    TRACE_REGION_END();
 }
 
-static double run_parallel(int requested_threads, int *actual_threads_out, long long *sum_out) {
+// Counters come from one extra pass after the timed samples, so reading
+// them never perturbs the timings.
+static int run_sequential(long long *sum_out, bench_samples_t *samples, perf_sample_t *counters) {
+    reduce_ctx_t ctx = { 1, 1, 0 };
+    if (bench_run(sequential_pass, &ctx, samples) != 0) return -1;
+    perf_begin_serial(counters);
+    sequential_pass(&ctx);
+    perf_end(counters);
+    if (sum_out) *sum_out = ctx.sum;
+    return 0;
+}
+
+static int run_parallel(int requested_threads, int *actual_threads_out, long long *sum_out, bench_samples_t *samples,
+                        perf_sample_t *counters) {
     // Fix the team size; avoid OpenMP dynamically changing it between runs
     omp_set_dynamic(0);
     omp_set_num_threads(requested_threads);
 
-    long long sum = 0;
-    int actual_threads = 0;
-    double best = 1e100;
+    reduce_ctx_t ctx = { requested_threads, 0, 0 };
+    if (bench_run(parallel_pass, &ctx, samples) != 0) return -1;
+    perf_begin(counters);
+    parallel_pass(&ctx);
+    perf_end(counters);
+    // The engine does not report its team; a region under the same ICVs
+    // gets the same one (OMP_THREAD_LIMIT and nesting included)
+    #pragma omp parallel
+    {
+        #pragma omp single
+        ctx.actual_threads = omp_get_num_threads();
+    }
+    if (actual_threads_out) *actual_threads_out = ctx.actual_threads;
+    if (sum_out) *sum_out = ctx.sum;
+    return 0;
+}
 
-    for (int t = 0; t < TRIALS; ++t) {
-        sum = 0;
-        double t0 = omp_get_wtime();
-        #pragma omp parallel
-        {
-            if (omp_get_thread_num() == 0) actual_threads = omp_get_num_threads();
-            #pragma omp for reduction(+:sum) schedule(static)
-            for (int i = 0; i < ARRAY_SIZE; ++i) {
-                sum += g_array[i];
+static int contains(const int *arr, int n, int v) {
+    for (int i = 0; i < n; ++i) if (arr[i] == v) return 1; return 0;
+}
+
+#ifdef USE_MPI
+// Hybrid MPI + OpenMP mode (build with mpicc -DUSE_MPI, or MPI=1 ./build.sh).
+// Every rank owns a contiguous slice of the global array (element g holds
+// g % MODVAL), reduces it with the same OpenMP reduction as the
+// single-node study, and the partial sums meet in MPI_Allreduce. One launch
+// sweeps ranks x threads: the ranks taking part in a configuration are
+// split into their own communicator and the others idle.
+//
+//   mpirun -np 4 ./part4_mpi                      (add --oversubscribe when
+//                                                  ranks x threads > cores)
+//
+// Strong scaling keeps ARRAY_SIZE elements in total; weak scaling keeps
+// ARRAY_SIZE / (ranks * threads at the largest configuration) elements per
+// core. Compute and communication times are the slowest rank's medians.
+// A barrier separates the two: its wait is the load imbalance between
+// ranks (reported as Wait), so Comm times only the Allreduce itself.
+#include <mpi.h>
+#include <time.h>
+
+#ifndef HYBRID_REPS
+#define HYBRID_REPS 15
+#endif
+
+typedef struct {
+    int ranks;
+    int threads;
+    long long elements;
+    double total;
+    double compute;
+    double wait;   // barrier after compute: ranks waiting for the slowest one
+    double comm;
+    long long sum;
+} hybrid_result_t;
+
+// Idle ranks wait on a non-blocking barrier and sleep between polls, so
+// they do not steal cores from the ranks being measured.
+static void hybrid_sync(int active) {
+    MPI_Request req;
+    MPI_Ibarrier(MPI_COMM_WORLD, &req);
+    if (active) {
+        MPI_Wait(&req, MPI_STATUS_IGNORE);
+        return;
+    }
+    int done = 0;
+    struct timespec nap = { 0, 1000000 };
+    while (MPI_Test(&req, &done, MPI_STATUS_IGNORE), !done) nanosleep(&nap, NULL);
+}
+
+static long long hybrid_slice_begin(long long total, int rank, int ranks) {
+    return total / ranks * rank + (rank < total % ranks ? rank : total % ranks);
+}
+
+// Runs one configuration on every rank of `comm`; the result is filled in
+// on rank 0 of `comm`.
+static void hybrid_measure(MPI_Comm comm, int ranks, int threads, long long total, int *slice,
+                           hybrid_result_t *out) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    long long lo = hybrid_slice_begin(total, rank, ranks);
+    long long hi = hybrid_slice_begin(total, rank + 1, ranks);
+    omp_set_dynamic(0);
+    omp_set_num_threads(threads);
+    dg_fill_mod(slice, (size_t)(hi - lo), MODVAL, (size_t)lo);
+
+    double compute[HYBRID_REPS], wait[HYBRID_REPS], comm_time[HYBRID_REPS], wall[HYBRID_REPS];
+    long long global = 0;
+    for (int r = -1; r < HYBRID_REPS; ++r) {   // r = -1 is the warmup
+        long long local = 0;
+        MPI_Barrier(comm);
+        double t0 = MPI_Wtime();
+        TRACE_REGION_BEGIN("part4/hybrid %dx%d", ranks, threads);
+        re_sum_i32(slice, (size_t)(hi - lo), RE_REDUCTION, &local);
+        TRACE_REGION_END();
+        double t1 = MPI_Wtime();
+        MPI_Barrier(comm);
+        double t2 = MPI_Wtime();
+        MPI_Allreduce(&local, &global, 1, MPI_LONG_LONG, MPI_SUM, comm);
+        double t3 = MPI_Wtime();
+        if (r < 0) continue;
+        compute[r] = t1 - t0;
+        wait[r] = t2 - t1;
+        comm_time[r] = t3 - t2;
+        wall[r] = t3 - t0;
+    }
+
+    double mine[4], slowest[4];
+    double *series[4] = { wall, compute, wait, comm_time };
+    for (int k = 0; k < 4; ++k) {
+        qsort(series[k], HYBRID_REPS, sizeof(double), bench_cmp_double);
+        mine[k] = bench_percentile(series[k], HYBRID_REPS, 0.5);
+    }
+    MPI_Reduce(mine, slowest, 4, MPI_DOUBLE, MPI_MAX, 0, comm);
+    if (rank == 0) {
+        hybrid_result_t res = { ranks, threads, total, slowest[0], slowest[1], slowest[2], slowest[3], global };
+        *out = res;
+    }
+}
+
+static void hybrid_print_table(const char *title, const hybrid_result_t *res, int n, int weak) {
+    printf("\n=== %s ===\n", title);
+    printf("%-6s %-8s %-6s %-12s %-11s %-11s %-11s %-11s %-7s %-9s %-10s %s\n", "Ranks", "Threads", "Cores",
+           "Elements", "Total(s)", "Compute(s)", "Wait(s)", "Comm(s)", "Comm%", weak ? "Scaled" : "Speedup",
+           "Efficiency", "Sum");
+    for (int i = 0; i < n; ++i) {
+        int cores = res[i].ranks * res[i].threads;
+        // weak: ideal time stays flat, so efficiency is T(1x1) / T
+        double speedup = weak ? res[0].total / res[i].total * cores : res[0].total / res[i].total;
+        double efficiency = speedup / cores * 100.0;
+        int ok = res[i].sum == expected_sum(res[i].elements);
+        printf("%-6d %-8d %-6d %-12lld %-11.6f %-11.6f %-11.6f %-11.6f %-7.1f %-9.2f %-10.1f %s\n", res[i].ranks,
+               res[i].threads, cores, res[i].elements, res[i].total, res[i].compute, res[i].wait, res[i].comm,
+               res[i].total > 0 ? res[i].comm / res[i].total * 100.0 : 0.0, speedup, efficiency, ok ? "✓" : "✗");
+    }
+}
+
+static int hybrid_main(void) {
+    int provided, world_rank, world_size;
+    MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    const int max_threads = omp_get_max_threads();
+
+    int candidates[] = {1,2,4,8,16,32,64,128};
+    int rank_tests[16], thread_tests[16];
+    int nr = 0, nth = 0;
+    for (int i = 0; i < (int)(sizeof(candidates)/sizeof(candidates[0])); ++i) {
+        if (candidates[i] <= world_size && nr < 15) rank_tests[nr++] = candidates[i];
+        if (candidates[i] <= max_threads && nth < 15) thread_tests[nth++] = candidates[i];
+    }
+    if (!contains(rank_tests, nr, world_size)) rank_tests[nr++] = world_size;
+    if (!contains(thread_tests, nth, max_threads)) thread_tests[nth++] = max_threads;
+
+    // Largest slice this rank ever holds: strong scaling with the fewest
+    // ranks that include it, or weak scaling at the maximum thread count.
+    long long weak_per_core = (long long)ARRAY_SIZE / ((long long)world_size * max_threads);
+    if (weak_per_core < 1) weak_per_core = 1;
+    long long slice_max = weak_per_core * max_threads + 1;
+    for (int i = 0; i < nr; ++i) {
+        if (world_rank >= rank_tests[i]) continue;
+        long long len = hybrid_slice_begin(ARRAY_SIZE, world_rank + 1, rank_tests[i]) -
+                        hybrid_slice_begin(ARRAY_SIZE, world_rank, rank_tests[i]);
+        if (len > slice_max) slice_max = len;
+    }
+    numa_array_t storage;
+    int alloc_failed = numa_array_alloc(&storage, (size_t)slice_max) != 0, any_failed = 0;
+    MPI_Allreduce(&alloc_failed, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+    if (any_failed) {
+        if (world_rank == 0) fprintf(stderr, "Memory allocation failed!\n");
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (world_rank == 0) {
+        printf("Performance Analysis - Hybrid MPI + OpenMP Scalability Study\n");
+        printf("Ranks: %d, threads per rank (max): %d, MPI thread support: %s\n", world_size, max_threads,
+               provided >= MPI_THREAD_FUNNELED ? "funneled" : "single");
+        printf("Strong scaling: %d elements in total; weak scaling: %lld elements per core\n",
+               ARRAY_SIZE, weak_per_core);
+        printf("Medians over %d repetitions (+1 warmup) of the slowest rank\n", HYBRID_REPS);
+    }
+
+    hybrid_result_t strong[256], weak[256];
+    int ns = 0;
+    for (int i = 0; i < nr; ++i) {
+        for (int j = 0; j < nth; ++j, ++ns) {
+            int ranks = rank_tests[i], threads = thread_tests[j];
+            int active = world_rank < ranks;
+            MPI_Comm comm;
+            MPI_Comm_split(MPI_COMM_WORLD, active ? 0 : MPI_UNDEFINED, world_rank, &comm);
+            if (active) {
+                hybrid_measure(comm, ranks, threads, ARRAY_SIZE, storage.data, &strong[ns]);
+                hybrid_measure(comm, ranks, threads, weak_per_core * ranks * threads, storage.data, &weak[ns]);
+                MPI_Comm_free(&comm);
             }
+            hybrid_sync(active);
         }
-        double t1 = omp_get_wtime();
-        if (t1 - t0 < best) best = t1 - t0;
     }
 
-    if (actual_threads_out) *actual_threads_out = actual_threads;
-    if (sum_out) *sum_out = sum;
-    return best;
+    if (world_rank == 0) {
+        hybrid_print_table("HYBRID STRONG SCALING", strong, ns, 0);
+        hybrid_print_table("HYBRID WEAK SCALING", weak, ns, 1);
+
+        // Where adding ranks stops paying off at a fixed thread count
+        printf("\n=== HYBRID ANALYSIS ===\n");
+        for (int j = 0; j < nth; ++j) {
+            int best = j;
+            for (int i = 1; i < nr; ++i) {
+                if (strong[i * nth + j].total < strong[best].total) best = i * nth + j;
+            }
+            printf("- %d thread(s) per rank: fastest with %d rank(s) (%.6f s, imbalance wait %.1f%%, "
+                   "communication %.1f%%)\n", thread_tests[j], strong[best].ranks, strong[best].total,
+                   strong[best].wait / strong[best].total * 100.0, strong[best].comm / strong[best].total * 100.0);
+        }
+        if (world_size * max_threads > omp_get_num_procs()) {
+            printf("- Ranks x threads beyond the core count oversubscribe the node; compare those rows with care\n");
+        }
+
+        printf("\n=== HYBRID CSV DATA ===\n");
+        printf("Mode,Ranks,Threads,Elements,Total,Compute,Wait,Comm\n");
+        for (int i = 0; i < ns; ++i) {
+            printf("strong,%d,%d,%lld,%.6f,%.6f,%.6f,%.6f\n", strong[i].ranks, strong[i].threads, strong[i].elements,
+                   strong[i].total, strong[i].compute, strong[i].wait, strong[i].comm);
+        }
+        for (int i = 0; i < ns; ++i) {
+            printf("weak,%d,%d,%lld,%.6f,%.6f,%.6f,%.6f\n", weak[i].ranks, weak[i].threads, weak[i].elements,
+                   weak[i].total, weak[i].compute, weak[i].wait, weak[i].comm);
+        }
+    }
+
+    numa_array_free(&storage);
+    MPI_Finalize();
+    return 0;
 }
+#endif
 
-static int contains(const int *arr, int n, int v) {
-    for (int i = 0; i < n; ++i) if (arr[i] == v) return 1; return 0;
+// The data only needs 10 bits per value, so the int32 sweep moves 3.2x the
+// bytes it has to. Sum over each compact layout against the int32 array at
+// every tested thread count; GB/s counts the bytes actually scanned.
+#define COMPACT_TIME_BUDGET 0.2
+
+typedef struct {
+    const cc_column_t *col;   // NULL: the int32 array
+    long long sum;
+} compact_ctx_t;
+
+static void compact_pass(void *arg) {
+    compact_ctx_t *ctx = (compact_ctx_t *)arg;
+    if (ctx->col) ctx->sum = cc_sum(ctx->col);
+    else re_sum_i32(g_array, ARRAY_SIZE, RE_REDUCTION, &ctx->sum);
+}
+
+static int run_compact_comparison(const int *threads, int nt) {
+    const cc_encoding_t layouts[] = { CC_U16, CC_PACKED, CC_FOR };
+    const int nl = (int)(sizeof(layouts) / sizeof(layouts[0]));
+    cc_column_t cols[3];
+    cc_column_t probe;
+    const long long exp = expected_sum(ARRAY_SIZE);
+    const double raw_bytes = (double)ARRAY_SIZE * sizeof(int);
+
+    if (cc_encode(&probe, g_array, ARRAY_SIZE, CC_AUTO) != 0) { cc_free(&probe); return -1; }
+    cc_encoding_t chosen = probe.encoding;
+    cc_free(&probe);
+    for (int l = 0; l < nl; ++l) {
+        if (cc_encode(&cols[l], g_array, ARRAY_SIZE, layouts[l]) != 0) {
+            for (int k = 0; k <= l; ++k) cc_free(&cols[k]);
+            return -1;
+        }
+    }
+
+    printf("%-8s %-10s %-8s %-10s %s\n", "Layout", "MB", "Ratio", "Bits/val", "Notes");
+    printf("%-8s %-10.1f %-8s %-10.2f\n", "int32", raw_bytes / 1e6, "1.00x", 32.0);
+    for (int l = 0; l < nl; ++l) {
+        double bytes = (double)cc_bytes(&cols[l]);
+        char ratio[16];
+        snprintf(ratio, sizeof(ratio), "%.2fx", raw_bytes / bytes);
+        printf("%-8s %-10.1f %-8s %-10.2f %s\n", cc_encoding_name(layouts[l]), bytes / 1e6, ratio,
+               bytes * 8.0 / ARRAY_SIZE, layouts[l] == chosen ? "auto choice" : "");
+    }
+
+    printf("\n%-8s %-8s %-12s %-10s %-12s %-10s %s\n", "Threads", "Layout", "Median(ms)", "Melem/s", "GB/s scanned",
+           "vs int32", "Check");
+    int ok = 1;
+    for (int t = 0; t < nt; ++t) {
+        omp_set_num_threads(threads[t]);
+        double base_time = 0.0;
+        for (int l = -1; l < nl; ++l) {
+            compact_ctx_t ctx = { l < 0 ? NULL : &cols[l], 0 };
+            bench_samples_t samples;
+            TRACE_REGION_BEGIN("part4/compact %s %d threads", l < 0 ? "int32" : cc_encoding_name(layouts[l]), threads[t]);
+            int status = bench_run_budget(compact_pass, &ctx, COMPACT_TIME_BUDGET, &samples);
+            TRACE_REGION_END();
+            if (status != 0) {
+                for (int k = 0; k < nl; ++k) cc_free(&cols[k]);
+                return -1;
+            }
+            double bytes = l < 0 ? raw_bytes : (double)cc_bytes(&cols[l]);
+            if (l < 0) base_time = samples.median;
+            ok &= ctx.sum == exp;
+            printf("%-8d %-8s %-12.3f %-10.1f %-12.2f %-10.2f %s\n", threads[t], l < 0 ? "int32" : cc_encoding_name(layouts[l]),
+                   samples.median * 1e3, ARRAY_SIZE / samples.median / 1e6, bytes / samples.median / 1e9,
+                   base_time / samples.median, ctx.sum == exp ? "✓" : "✗");
+            bench_free(&samples);
+        }
+    }
+    if (!ok) printf("✗ Sum mismatch on a compact layout\n");
+    for (int l = 0; l < nl; ++l) cc_free(&cols[l]);
+    return 0;
+}
+
+// Many small reductions instead of one big one: per-call latency of the
+// same SIMD kernel run serially, through an OpenMP parallel region, and on
+// the persistent pool, from 1K elements up to ARRAY_SIZE. The crossover is
+// the smallest size from which the pool wins at every larger size; the pool
+// then runs serially below it on its own (the "auto" column).
+#define SMALL_MIN_ELEMENTS 1024
+#define SMALL_TIME_BUDGET 0.05
+
+typedef struct {
+    sum_kernel_fn kernel;
+    tp_pool_t *pool;
+    size_t n;
+    long long sum;
+    int method;   // 0 serial, 1 OpenMP, 2 pool, 3 pool with serial fallback
+} small_ctx_t;
+
+static void small_pass(void *arg) {
+    small_ctx_t *ctx = (small_ctx_t *)arg;
+    switch (ctx->method) {
+    case 0: ctx->sum = ctx->kernel(g_array, ctx->n); break;
+    case 1: ctx->sum = sum_i32_parallel(ctx->kernel, g_array, ctx->n); break;
+    default: ctx->sum = tp_sum_i32(ctx->pool, ctx->kernel, g_array, ctx->n); break;
+    }
+}
+
+static int run_small_reduction_sweep(void) {
+    size_t sizes[16];
+    int ns = 0;
+    for (size_t n = SMALL_MIN_ELEMENTS; n < (size_t)ARRAY_SIZE && ns < 15; n *= 4) sizes[ns++] = n;
+    sizes[ns++] = ARRAY_SIZE;
+
+    tp_pool_t pool;
+    if (tp_init(&pool, omp_get_max_threads()) != 0) return -1;
+    small_ctx_t ctx = { sum_kernel_for(simd_isa_select()), &pool, 0, 0, 0 };
+    double median[16][4];
+    int ok = 1;
+
+    printf("Team: %d threads; pool workers spin %d pauses, then park\n", pool.nthreads, pool.spin_iters);
+    printf("%-12s %-12s %-12s %-12s %-10s %s\n", "Elements", "Serial(us)", "OpenMP(us)", "Pool(us)", "Pool/OMP", "Check");
+    for (int i = 0; i < ns; ++i) {
+        ctx.n = sizes[i];
+        for (int m = 0; m < 3; ++m) {
+            bench_samples_t samples;
+            ctx.method = m;
+            TRACE_REGION_BEGIN("part4/small %zu m%d", sizes[i], m);
+            int status = bench_run_budget(small_pass, &ctx, SMALL_TIME_BUDGET, &samples);
+            TRACE_REGION_END();
+            if (status != 0) { tp_destroy(&pool); return -1; }
+            median[i][m] = samples.median;
+            ok &= ctx.sum == expected_sum((long long)sizes[i]);
+            bench_free(&samples);
+        }
+        printf("%-12zu %-12.2f %-12.2f %-12.2f %-10.2f %s\n", sizes[i], median[i][0] * 1e6, median[i][1] * 1e6,
+               median[i][2] * 1e6, median[i][2] / median[i][1], ok ? "✓" : "✗");
+    }
+
+    // crossover[m]: first index from which method m beats serial at every larger size
+    int crossover[3] = { 0, ns, ns };
+    for (int m = 1; m < 3; ++m) {
+        for (int i = ns - 1; i >= 0 && median[i][m] < median[i][0]; --i) crossover[m] = i;
+    }
+    for (int m = 1; m < 3; ++m) {
+        const char *name = m == 1 ? "OpenMP region" : "Pool";
+        if (crossover[m] == ns) printf("%s: never faster than serial at %d threads\n", name, pool.nthreads);
+        else printf("%s: going parallel is a loss below %zu elements\n", name, sizes[crossover[m]]);
+    }
+
+    pool.serial_below = crossover[2] == ns ? (size_t)-1 : sizes[crossover[2]];
+    if (crossover[2] == ns) printf("Pool with serial fallback at every size:\n");
+    else printf("Pool with serial fallback below %zu elements:\n", pool.serial_below);
+    printf("%-12s %-12s %s\n", "Elements", "Auto(us)", "vs best of serial/pool");
+    ctx.method = 3;
+    for (int i = 0; i < ns; ++i) {
+        bench_samples_t samples;
+        ctx.n = sizes[i];
+        if (bench_run_budget(small_pass, &ctx, SMALL_TIME_BUDGET, &samples) != 0) { tp_destroy(&pool); return -1; }
+        double best = median[i][0] < median[i][2] ? median[i][0] : median[i][2];
+        printf("%-12zu %-12.2f %.2fx\n", sizes[i], samples.median * 1e6, samples.median / best);
+        ok &= ctx.sum == expected_sum((long long)sizes[i]);
+        bench_free(&samples);
+    }
+    if (!ok) printf("✗ Sum mismatch in the small-reduction sweep\n");
+    tp_destroy(&pool);
+    return 0;
+}
+
+// Roofline point of the sum kernel and scaling-law fits over the sweep.
+// The kernel does one (widening) add per 4-byte element, so its arithmetic
+// intensity is 0.25 op/byte; the compute roof is the FP64 FMA peak, which
+// on current x86 cores matches the vector integer add throughput.
+static void print_roofline_analysis(const int *threads, const bench_samples_t *par, const double *speedup, int nt,
+                                    const bench_samples_t *seq) {
+    const double bytes = (double)ARRAY_SIZE * sizeof(int);
+    const double intensity = (double)ARRAY_SIZE / bytes;
+    const char *fma_isa;
+    TRACE_REGION_BEGIN("part4/roofline peaks");
+    double peak_gbs = stream_peak_gbs();
+    double peak_gflops = sm_peak_gflops(&fma_isa);
+    TRACE_REGION_END();
+
+    printf("\n=== ROOFLINE ===\n");
+    if (peak_gbs <= 0) {
+        printf("STREAM triad buffers could not be allocated; roofline skipped\n");
+        return;
+    }
+    double ridge = peak_gflops / peak_gbs;
+    double attainable = fmin(peak_gflops, intensity * peak_gbs);
+    printf("Compute roof: %.1f GFLOP/s (FP64 FMA, %s, %d threads)\n", peak_gflops, fma_isa, omp_get_max_threads());
+    printf("Memory roof: %.2f GB/s (STREAM triad, %d threads)\n", peak_gbs, omp_get_max_threads());
+    printf("Ridge point: %.2f op/byte; kernel intensity: %.2f op/byte -> %s-bound, attainable %.2f Gop/s\n",
+           ridge, intensity, intensity < ridge ? "bandwidth" : "compute", attainable);
+    printf("%-8s %-10s %-10s %-10s %s\n", "Threads", "GB/s", "% of BW", "Gop/s", "% of roof");
+
+    double gbs[16];
+    double seq_gbs = bytes / seq->median / 1e9;
+    for (int i = 0; i < nt; ++i) {
+        gbs[i] = bytes / par[i].median / 1e9;
+        double gops = ARRAY_SIZE / par[i].median / 1e9;
+        printf("%-8d %-10.2f %-10.1f %-10.2f %.1f\n", threads[i], gbs[i], gbs[i] / peak_gbs * 100.0, gops,
+               gops / attainable * 100.0);
+    }
+    int sat = sm_saturation_index(gbs, nt, 0.9);
+    int bandwidth_limited = gbs[sat] >= 0.7 * peak_gbs;
+    if (bandwidth_limited) {
+        printf("DRAM bandwidth saturates at %d threads (%.2f GB/s, %.0f%% of STREAM); more threads add little\n",
+               threads[sat], gbs[sat], gbs[sat] / peak_gbs * 100.0);
+    } else {
+        printf("Best achieved bandwidth is %.0f%% of STREAM: not bandwidth-limited in this sweep\n",
+               gbs[sat] / peak_gbs * 100.0);
+    }
+
+    printf("\n=== SCALING MODEL FIT ===\n");
+    double f, a;
+    int used = sm_fit_amdahl(threads, speedup, nt, &f);
+    sm_fit_gustafson(threads, speedup, nt, &a);
+    if (used == 0) {
+        printf("Model fit needs at least one run with more than one thread\n");
+        return;
+    }
+    char limit_col[32];
+    if (f > 0) snprintf(limit_col, sizeof(limit_col), "%.1fx", 1.0 / f);
+    else snprintf(limit_col, sizeof(limit_col), "unbounded");
+    printf("Amdahl:    serial fraction %.4f, speedup limit %s, RMS error %.1f%%\n", f, limit_col,
+           sm_rms_error(sm_amdahl, f, threads, speedup, nt) * 100.0);
+    printf("Gustafson: serial fraction %.4f, RMS error %.1f%% (scaled speedup if N grew with p)\n", a,
+           sm_rms_error(sm_gustafson, a, threads, speedup, nt) * 100.0);
+
+    // Bandwidth cap: no thread count moves more bytes than STREAM does.
+    double bw_cap = peak_gbs / seq_gbs;
+    printf("Bandwidth cap: %.2fx (STREAM peak / single-thread bandwidth)\n", bw_cap);
+    printf("%-8s %-10s %-11s %-10s %s\n", "Threads", "Amdahl", "Gustafson", "BW cap", "Predicted");
+    int predict[] = {2,3,4,6,8,12,16,24,32,48,64,96,128};
+    int limit = threads[nt - 1] * 4 > 8 ? threads[nt - 1] * 4 : 8;
+    int recommended = 1;
+    double best_predicted = 1.0;
+    for (int i = 0; i < (int)(sizeof(predict)/sizeof(predict[0])) && predict[i] <= limit; ++i) {
+        double s_amdahl = sm_amdahl(f, predict[i]);
+        double predicted = fmin(s_amdahl, bw_cap);
+        if (predicted > best_predicted * 1.05) { best_predicted = predicted; recommended = predict[i]; }
+        if (contains(threads, nt, predict[i])) continue;
+        printf("%-8d %-10.2f %-11.2f %-10.2f %.2f\n", predict[i], s_amdahl, sm_gustafson(a, predict[i]), bw_cap,
+               predicted);
+    }
+    printf("Recommendation: %d core(s) (beyond that the predicted speedup grows by less than 5%% per step%s)\n",
+           recommended, best_predicted >= bw_cap ? ", capped by DRAM bandwidth" : "");
 }
 
 int main() {
+#ifdef USE_MPI
+    return hybrid_main();
+#endif
     printf("Performance Analysis - Scalability Study (Improved)\n");
     init_array_once();
 
     const int MAX_THREADS_INIT = omp_get_max_threads(); // capture once; don't let later calls affect logic
     printf("Array size: %d elements\n", ARRAY_SIZE);
-    printf("Maximum threads available (initial): %d\n\n", MAX_THREADS_INIT);
+    printf("Maximum threads available (initial): %d\n", MAX_THREADS_INIT);
+    printf("Setup time (allocation + fill): %.6f s\n", g_setup_time);
+    perf_print_status();
+    TRACE_REGION_BEGIN("part4/placement report");
+    numa_report(&g_storage);
+    TRACE_REGION_END();
+    printf("\n");
 
     // Build test set: {1,2,4,8,16,32} intersected with [1..MAX_THREADS_INIT], plus MAX_THREADS_INIT if missing
     int candidates[] = {1,2,4,8,16,32};
@@ -97,34 +588,49 @@ int main() {
 
     // Sequential baseline
     long long seq_sum = 0;
-    double seq_time = run_sequential(&seq_sum);
+    bench_samples_t seq;
+    static perf_sample_t seq_counters, par_counters[16];
+    if (run_sequential(&seq_sum, &seq, &seq_counters) != 0) { fprintf(stderr, "Memory allocation failed!\n"); return 1; }
     long long exp_sum = expected_sum(ARRAY_SIZE);
     printf("=== SEQUENTIAL BASELINE ===\n");
-    printf("Sequential - Sum: %lld (expected %lld), Best Time over %d run(s): %.6f s\n\n", seq_sum, exp_sum, TRIALS, seq_time);
+    printf("Sequential - Sum: %lld (expected %lld), Median over %d run(s) (+%d warmup): %.6f s [p5 %.6f, p95 %.6f]\n\n",
+           seq_sum, exp_sum, seq.reps, seq.warmup, seq.median, seq.p5, seq.p95);
+    perf_print_row("counters", &seq_counters, ARRAY_SIZE);
+    if (perf_available()) printf("\n");
 
     // Parallel tests
     printf("=== PARALLEL PERFORMANCE TESTING ===\n");
-    double times[16];
+    bench_samples_t par[16];
+    bench_ci_t speedup_ci[16];
     int actual_threads[16];
     long long par_sum = 0;
 
     for (int i = 0; i < nt; ++i) {
-        times[i] = run_parallel(tests[i], &actual_threads[i], &par_sum);
-        printf("Requested: %2d, Actual: %2d, Sum: %lld, Best Time: %.6f s\n", tests[i], actual_threads[i], par_sum, times[i]);
+        if (run_parallel(tests[i], &actual_threads[i], &par_sum, &par[i], &par_counters[i]) != 0) { fprintf(stderr, "Memory allocation failed!\n"); return 1; }
+        speedup_ci[i] = bench_ratio_ci(&seq, &par[i]);
+        printf("Requested: %2d, Actual: %2d, Sum: %lld, Median Time: %.6f s over %d run(s)\n",
+               tests[i], actual_threads[i], par_sum, par[i].median, par[i].reps);
+        perf_print_row("counters", &par_counters[i], ARRAY_SIZE);
     }
 
     // Table
     printf("\n=== PERFORMANCE ANALYSIS TABLE ===\n");
-    printf("%-8s %-12s %-10s %-12s %-12s\n", "Threads", "Time (sec)", "Speedup", "Efficiency", "Notes");
-    printf("------------------------------------------------------------\n");
+    printf("Speedup and efficiency: median ratio with %.0f%% bootstrap confidence interval\n", BENCH_CI_LEVEL * 100);
+    printf("%-8s %-10s %-10s %-10s %-22s %-26s %-10s\n", "Threads", "Median(s)", "p5(s)", "p95(s)", "Speedup [CI]", "Efficiency [CI]", "Notes");
+    printf("----------------------------------------------------------------------------------------------------\n");
 
     double best_speedup = 0.0; int best_threads = tests[0];
     for (int i = 0; i < nt; ++i) {
-        double speedup = seq_time / times[i];
+        double speedup = speedup_ci[i].estimate;
         double efficiency = (speedup / actual_threads[i]) * 100.0;
         if (speedup > best_speedup) { best_speedup = speedup; best_threads = actual_threads[i]; }
         const char *note = (efficiency > 80.0) ? "Excellent" : (efficiency > 60.0) ? "Good" : (efficiency > 40.0) ? "Fair" : "Poor";
-        printf("%-8d %-12.4f %-10.2f %-11.2f%% %s\n", actual_threads[i], times[i], speedup, efficiency, note);
+        char speedup_col[32], efficiency_col[32];
+        snprintf(speedup_col, sizeof(speedup_col), "%.2f [%.2f, %.2f]", speedup, speedup_ci[i].lo, speedup_ci[i].hi);
+        snprintf(efficiency_col, sizeof(efficiency_col), "%.1f%% [%.1f, %.1f]", efficiency,
+                 speedup_ci[i].lo / actual_threads[i] * 100.0, speedup_ci[i].hi / actual_threads[i] * 100.0);
+        printf("%-8d %-10.4f %-10.4f %-10.4f %-22s %-26s %s\n", actual_threads[i], par[i].median, par[i].p5, par[i].p95,
+               speedup_col, efficiency_col, note);
     }
 
     printf("\n=== OPTIMAL CONFIGURATION ===\n");
@@ -132,25 +638,52 @@ int main() {
     printf("Maximum speedup: %.2fx\n", best_speedup);
     printf("Best efficiency: %.2f%%\n\n", (best_speedup / best_threads) * 100.0);
 
-    // Trend analysis (monotonicity check)
+    // Trend analysis: a drop only counts when the bootstrap interval of
+    // speedup(cur) / speedup(prev) lies entirely below 1
     printf("=== TREND ANALYSIS ===\n");
+    int degradations = 0;
     for (int i = 1; i < nt; ++i) {
-        double s_prev = seq_time / times[i-1];
-        double s_cur  = seq_time / times[i];
-        if (s_cur + 1e-9 < 0.95 * s_prev) {
-            printf("- Performance degradation detected at %d threads (%.2fx -> %.2fx)\n", actual_threads[i], s_prev, s_cur);
+        bench_ci_t step = bench_ratio_ci(&par[i-1], &par[i]);
+        double s_prev = speedup_ci[i-1].estimate;
+        double s_cur  = speedup_ci[i].estimate;
+        if (step.estimate < 0.95 && step.hi < 1.0) {
+            degradations++;
+            printf("- Performance degradation detected at %d threads (%.2fx -> %.2fx, ratio %.3f, CI [%.3f, %.3f])\n",
+                   actual_threads[i], s_prev, s_cur, step.estimate, step.lo, step.hi);
+        } else if (step.estimate < 0.95) {
+            printf("- Drop at %d threads (%.2fx -> %.2fx) is not significant (ratio CI [%.3f, %.3f])\n",
+                   actual_threads[i], s_prev, s_cur, step.lo, step.hi);
         }
     }
+    if (degradations == 0) printf("- No statistically significant degradation\n");
+
+    double speedups[16];
+    for (int i = 0; i < nt; ++i) speedups[i] = speedup_ci[i].estimate;
+    print_roofline_analysis(actual_threads, par, speedups, nt, &seq);
+    printf("\n");
+
+    printf("=== COMPACT STORAGE ===\n");
+    if (run_compact_comparison(actual_threads, nt) != 0) { fprintf(stderr, "Memory allocation failed!\n"); return 1; }
+    omp_set_num_threads(MAX_THREADS_INIT);
+    printf("\n");
+
+    printf("=== SMALL-REDUCTION LATENCY ===\n");
+    if (run_small_reduction_sweep() != 0) { fprintf(stderr, "Memory allocation failed!\n"); return 1; }
+    printf("\n");
 
     // CSV output
     printf("=== CSV DATA FOR GRAPHING ===\n");
-    printf("Threads,Time,Speedup,Efficiency\n");
+    printf("Threads,Time,Speedup,Efficiency,TimeP5,TimeP95,SpeedupLo,SpeedupHi,EfficiencyLo,EfficiencyHi,Reps\n");
     for (int i = 0; i < nt; ++i) {
-        double speedup = seq_time / times[i];
+        double speedup = speedup_ci[i].estimate;
         double efficiency = (speedup / actual_threads[i]) * 100.0;
-        printf("%d,%.6f,%.2f,%.2f\n", actual_threads[i], times[i], speedup, efficiency);
+        printf("%d,%.6f,%.2f,%.2f,%.6f,%.6f,%.2f,%.2f,%.2f,%.2f,%d\n", actual_threads[i], par[i].median, speedup, efficiency,
+               par[i].p5, par[i].p95, speedup_ci[i].lo, speedup_ci[i].hi,
+               speedup_ci[i].lo / actual_threads[i] * 100.0, speedup_ci[i].hi / actual_threads[i] * 100.0, par[i].reps);
     }
 
-    free(g_array);
+    for (int i = 0; i < nt; ++i) bench_free(&par[i]);
+    bench_free(&seq);
+    numa_array_free(&g_storage);
     return 0;
 }
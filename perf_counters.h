@@ -0,0 +1,317 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters per OpenMP thread, via perf_event_open.
+//
+// The master opens one counter set for every thread of the current team
+// (by TID, so nothing has to run inside the measured regions) and reads
+// them before and after a region. perf_begin() first runs a tiny parallel
+// region to learn the team's TIDs; OpenMP runtimes keep their threads alive
+// between regions, so those are the threads that run the next region.
+// Counters are user-space only and scaled for multiplexing.
+//
+// Memory-controller (uncore IMC) CAS counts are added when the kernel exposes
+// uncore_imc_* PMUs and allows system-wide counting; otherwise bytes per
+// element are estimated from LLC misses x 64 B.
+//
+// Everything degrades to "timing only" when perf_event_open is unavailable
+// (non-Linux, perf_event_paranoid, containers, VMs without a PMU).
+
+enum {
+    PERF_EV_CYCLES,
+    PERF_EV_INSTRUCTIONS,
+    PERF_EV_LLC_MISSES,
+    PERF_EV_BRANCHES,
+    PERF_EV_BRANCH_MISSES,
+    PERF_EV_COUNT
+};
+
+#define PERF_MAX_THREADS 256
+#define PERF_MAX_IMC 128   // fds: IMC PMUs x 2 events x sockets
+#define PERF_CACHE_LINE 64
+
+typedef struct {
+    int tid;
+    int fds[PERF_EV_COUNT];
+} perf_thread_t;
+
+typedef struct {
+    int initialized;
+    int available;
+    char reason[96];
+    int nthreads;
+    perf_thread_t threads[PERF_MAX_THREADS];
+    int imc_count;
+    int imc_fds[PERF_MAX_IMC];
+} perf_session_t;
+
+typedef struct {
+    int nthreads;
+    int tids[PERF_MAX_THREADS];
+    double start[PERF_MAX_THREADS][PERF_EV_COUNT];
+    double delta[PERF_MAX_THREADS][PERF_EV_COUNT];
+    double totals[PERF_EV_COUNT];
+    double imc_start;
+    double imc_bytes;       // < 0 when no uncore counters
+    double seconds;
+} perf_sample_t;
+
+static perf_session_t perf_session;
+
+#ifdef __linux__
+static inline int perf_open(uint32_t type, uint64_t config, int pid, int cpu, int exclude_kernel) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = (unsigned)exclude_kernel;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, pid, cpu, -1, 0);
+}
+
+static inline double perf_read_scaled(int fd) {
+    uint64_t buf[3];
+    if (fd < 0 || read(fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) return 0.0;
+    if (buf[2] == 0) return 0.0;
+    return (double)buf[0] * ((double)buf[1] / (double)buf[2]);
+}
+
+static inline int perf_open_thread(perf_thread_t *t, int tid) {
+    static const uint64_t configs[PERF_EV_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    t->tid = tid;
+    for (int e = 0; e < PERF_EV_COUNT; ++e) {
+        t->fds[e] = perf_open(PERF_TYPE_HARDWARE, configs[e], tid, -1, 1);
+    }
+    return t->fds[PERF_EV_CYCLES] >= 0 && t->fds[PERF_EV_INSTRUCTIONS] >= 0 ? 0 : -1;
+}
+
+// "event=0x04,umask=0x03" -> config for a raw uncore event
+static inline int perf_parse_uncore_event(const char *path, uint64_t *config) {
+    FILE *f = fopen(path, "r");
+    char line[128];
+    unsigned event = 0, umask = 0;
+    if (!f) return -1;
+    if (!fgets(line, sizeof(line), f)) { fclose(f); return -1; }
+    fclose(f);
+    for (char *tok = strtok(line, ",\n"); tok; tok = strtok(NULL, ",\n")) {
+        if (strncmp(tok, "event=", 6) == 0) event = (unsigned)strtoul(tok + 6, NULL, 0);
+        else if (strncmp(tok, "umask=", 6) == 0) umask = (unsigned)strtoul(tok + 6, NULL, 0);
+    }
+    *config = event | (uint64_t)umask << 8;
+    return 0;
+}
+
+// A PMU's cpumask lists the CPUs to open it on, one per socket, as a cpu
+// list ("0,28" or "0-1"). Returns the count; a missing file means CPU 0.
+static inline int perf_uncore_cpus(const char *pmu, int *cpus, int max) {
+    char path[512], line[256];
+    snprintf(path, sizeof(path), "/sys/bus/event_source/devices/%s/cpumask", pmu);
+    FILE *f = fopen(path, "r");
+    int count = 0;
+    if (!f || !fgets(line, sizeof(line), f)) {
+        if (f) fclose(f);
+        cpus[0] = 0;
+        return 1;
+    }
+    fclose(f);
+    for (char *tok = strtok(line, ",\n"); tok && count < max; tok = strtok(NULL, ",\n")) {
+        char *dash = strchr(tok, '-');
+        int first = atoi(tok), last = dash ? atoi(dash + 1) : first;
+        for (int cpu = first; cpu <= last && count < max; ++cpu) cpus[count++] = cpu;
+    }
+    if (count == 0) cpus[count++] = 0;
+    return count;
+}
+
+static inline void perf_open_uncore(perf_session_t *s) {
+    DIR *dir = opendir("/sys/bus/event_source/devices");
+    struct dirent *ent;
+    if (!dir) return;
+    while ((ent = readdir(dir)) && s->imc_count < PERF_MAX_IMC) {
+        if (strncmp(ent->d_name, "uncore_imc", 10) != 0) continue;
+        char path[512];
+        unsigned type;
+        FILE *f;
+        snprintf(path, sizeof(path), "/sys/bus/event_source/devices/%s/type", ent->d_name);
+        if (!(f = fopen(path, "r"))) continue;
+        int ok = fscanf(f, "%u", &type) == 1;
+        fclose(f);
+        if (!ok) continue;
+        // uncore PMUs count system-wide for one socket on one CPU of it;
+        // open every CPU in the cpumask so each socket's controllers count
+        int cpus[PERF_MAX_IMC];
+        int ncpus = perf_uncore_cpus(ent->d_name, cpus, PERF_MAX_IMC);
+        static const char *events[] = { "cas_count_read", "cas_count_write" };
+        for (int k = 0; k < 2; ++k) {
+            uint64_t config;
+            snprintf(path, sizeof(path), "/sys/bus/event_source/devices/%s/events/%s", ent->d_name, events[k]);
+            if (perf_parse_uncore_event(path, &config) != 0) continue;
+            for (int c = 0; c < ncpus && s->imc_count < PERF_MAX_IMC; ++c) {
+                int fd = perf_open(type, config, -1, cpus[c], 0);
+                if (fd >= 0) s->imc_fds[s->imc_count++] = fd;
+            }
+        }
+    }
+    closedir(dir);
+}
+#endif
+
+static inline void perf_init(void) {
+    perf_session_t *s = &perf_session;
+    if (s->initialized) return;
+    s->initialized = 1;
+#ifdef __linux__
+    perf_thread_t probe;
+    if (perf_open_thread(&probe, 0) != 0) {
+        FILE *f = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+        int paranoid = 99;
+        if (f) { if (fscanf(f, "%d", &paranoid) != 1) paranoid = 99; fclose(f); }
+        snprintf(s->reason, sizeof(s->reason), "perf_event_open failed (perf_event_paranoid=%d, or no PMU)", paranoid);
+        for (int e = 0; e < PERF_EV_COUNT; ++e) if (probe.fds[e] >= 0) close(probe.fds[e]);
+        return;
+    }
+    for (int e = 0; e < PERF_EV_COUNT; ++e) close(probe.fds[e]);
+    s->available = 1;
+    perf_open_uncore(s);
+#else
+    snprintf(s->reason, sizeof(s->reason), "perf_event_open is Linux-only");
+#endif
+}
+
+static inline int perf_available(void) {
+    perf_init();
+    return perf_session.available;
+}
+
+// Learn the current team's TIDs and open counters for threads not seen yet.
+static inline void perf_attach_team(perf_sample_t *sample) {
+#ifdef __linux__
+    perf_session_t *s = &perf_session;
+    int tids[PERF_MAX_THREADS];
+    int team = 0;
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        if (t == 0) team = omp_get_num_threads();
+        if (t < PERF_MAX_THREADS) tids[t] = (int)syscall(SYS_gettid);
+    }
+    if (team > PERF_MAX_THREADS) team = PERF_MAX_THREADS;
+    sample->nthreads = team;
+    for (int t = 0; t < team; ++t) {
+        sample->tids[t] = tids[t];
+        int known = 0;
+        for (int k = 0; k < s->nthreads; ++k) if (s->threads[k].tid == tids[t]) known = 1;
+        if (!known && s->nthreads < PERF_MAX_THREADS) {
+            perf_open_thread(&s->threads[s->nthreads], tids[t]);
+            s->nthreads++;
+        }
+    }
+#else
+    sample->nthreads = 0;
+#endif
+}
+
+static inline const perf_thread_t *perf_thread_for(int tid) {
+    for (int k = 0; k < perf_session.nthreads; ++k) {
+        if (perf_session.threads[k].tid == tid) return &perf_session.threads[k];
+    }
+    return NULL;
+}
+
+static inline double perf_read_imc(void) {
+    double total = 0.0;
+#ifdef __linux__
+    for (int k = 0; k < perf_session.imc_count; ++k) total += perf_read_scaled(perf_session.imc_fds[k]);
+#endif
+    return total;
+}
+
+static inline void perf_begin(perf_sample_t *sample) {
+    memset(sample, 0, sizeof(*sample));
+    sample->imc_bytes = -1.0;
+    if (!perf_available()) return;
+#ifdef __linux__
+    perf_attach_team(sample);
+    for (int t = 0; t < sample->nthreads; ++t) {
+        const perf_thread_t *pt = perf_thread_for(sample->tids[t]);
+        for (int e = 0; e < PERF_EV_COUNT; ++e) sample->start[t][e] = pt ? perf_read_scaled(pt->fds[e]) : 0.0;
+    }
+    sample->imc_start = perf_read_imc();
+    sample->seconds = omp_get_wtime();
+#endif
+}
+
+// Serial sections: count only the calling (master) thread, so the spin-wait
+// of idle pool workers does not show up in the totals.
+static inline void perf_begin_serial(perf_sample_t *sample) {
+    perf_begin(sample);
+    if (sample->nthreads > 1) sample->nthreads = 1;
+}
+
+static inline void perf_end(perf_sample_t *sample) {
+    if (!perf_session.available) return;
+#ifdef __linux__
+    sample->seconds = omp_get_wtime() - sample->seconds;
+    for (int t = 0; t < sample->nthreads; ++t) {
+        const perf_thread_t *pt = perf_thread_for(sample->tids[t]);
+        for (int e = 0; e < PERF_EV_COUNT; ++e) {
+            double now = pt ? perf_read_scaled(pt->fds[e]) : 0.0;
+            sample->delta[t][e] = now - sample->start[t][e];
+            sample->totals[e] += sample->delta[t][e];
+        }
+    }
+    if (perf_session.imc_count > 0) sample->imc_bytes = (perf_read_imc() - sample->imc_start) * PERF_CACHE_LINE;
+#endif
+}
+
+// One line under a timing row: IPC (team total and the per-thread spread),
+// memory traffic per element and the branch mispredict rate.
+static inline void perf_print_row(const char *label, const perf_sample_t *sample, double elements) {
+    if (!perf_session.available) return;
+    const double *tot = sample->totals;
+    double ipc_min = 1e100, ipc_max = 0.0;
+    for (int t = 0; t < sample->nthreads; ++t) {
+        const double *d = sample->delta[t];
+        if (d[PERF_EV_CYCLES] < 1e5) continue;   // thread idle in this region
+        double ipc = d[PERF_EV_INSTRUCTIONS] / d[PERF_EV_CYCLES];
+        if (ipc < ipc_min) ipc_min = ipc;
+        if (ipc > ipc_max) ipc_max = ipc;
+    }
+    printf("    %s: IPC %.2f", label, tot[PERF_EV_CYCLES] > 0 ? tot[PERF_EV_INSTRUCTIONS] / tot[PERF_EV_CYCLES] : 0.0);
+    if (ipc_max > 0) printf(" (threads %.2f-%.2f)", ipc_min, ipc_max);
+    if (sample->imc_bytes >= 0) {
+        printf(", DRAM %.2f B/elem (%.2f GB/s)", sample->imc_bytes / elements, sample->imc_bytes / sample->seconds / 1e9);
+    } else {
+        printf(", LLC-miss %.2f B/elem", tot[PERF_EV_LLC_MISSES] * PERF_CACHE_LINE / elements);
+    }
+    printf(", mispredict %.2f%%", tot[PERF_EV_BRANCHES] > 0 ? tot[PERF_EV_BRANCH_MISSES] / tot[PERF_EV_BRANCHES] * 100 : 0.0);
+    printf(", %.2f instr/elem\n", tot[PERF_EV_INSTRUCTIONS] / elements);
+}
+
+static inline void perf_print_status(void) {
+    if (perf_available()) {
+        printf("Hardware counters: enabled (%d uncore IMC counters)\n", perf_session.imc_count);
+    } else {
+        printf("Hardware counters: unavailable, timing only (%s)\n", perf_session.reason);
+    }
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+
+// A full matrix is 6 types x 5 ops x 6 strategies; keep each cell short.
+#define BENCH_TARGET_SECONDS 0.2
+#include "bench_harness.h"
+#include "reduce_engine.h"
+
+// Benchmark matrix over the reduction engine. Every cell is checked against
+// the sequential strategy of the same type and operator.
+//
+//   ./reduce_bench [elements]
+//   RE_TYPES=int32,double RE_OPS=sum,histogram RE_STRATEGIES=reduction,tree
+//
+// Filters are comma-separated names; unset means all.
+
+#define DEFAULT_ELEMENTS 20000000
+#define HIST_BINS 64
+#define VALUE_RANGE 1000   // element i holds (i % VALUE_RANGE) - VALUE_RANGE / 2
+
+typedef struct {
+    re_type_t type;
+    re_op_t op;
+    re_strategy_t strategy;
+    const void *data;
+    size_t n;
+    const re_hist_spec_t *spec;
+    re_result_t result;
+    int status;
+} cell_ctx_t;
+
+static void run_cell(void *arg) {
+    cell_ctx_t *ctx = (cell_ctx_t *)arg;
+    ctx->status = re_run(ctx->type, ctx->op, ctx->strategy, ctx->data, ctx->n, ctx->spec, &ctx->result);
+}
+
+static int selected(const char *env, const char *name) {
+    const char *list = getenv(env);
+    if (!list || !*list) return 1;
+    size_t len = strlen(name);
+    for (const char *p = list; (p = strstr(p, name)) != NULL; p += len) {
+        int starts = p == list || p[-1] == ',';
+        int ends = p[len] == '\0' || p[len] == ',';
+        if (starts && ends) return 1;
+    }
+    return 0;
+}
+
+static void *make_data(re_type_t type, size_t n) {
+    void *data = malloc(re_type_size(type) * n);
+    if (!data) return NULL;
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        long v = (long)(i % VALUE_RANGE) - VALUE_RANGE / 2;
+        switch (type) {
+        case RE_I8:  ((int8_t *)data)[i] = (int8_t)(v % 128); break;
+        case RE_I16: ((int16_t *)data)[i] = (int16_t)v; break;
+        case RE_I32: ((int32_t *)data)[i] = (int32_t)v; break;
+        case RE_I64: ((int64_t *)data)[i] = (int64_t)v * 1000003; break;
+        case RE_F32: ((float *)data)[i] = (float)v * 0.5f; break;
+        case RE_F64: ((double *)data)[i] = (double)v * 0.5; break;
+        default: break;
+        }
+    }
+    return data;
+}
+
+// Floating-point sums differ in the last bits between combination orders.
+static int same_result(re_type_t type, re_op_t op, const re_result_t *a, const re_result_t *b, int nbins) {
+    if (op == RE_OP_HISTOGRAM) return memcmp(a->bins, b->bins, sizeof(long long) * (size_t)nbins) == 0;
+    if (op == RE_OP_COUNT_IF || !re_type_is_float(type)) return a->value.i == b->value.i;
+    return fabs(a->value.f - b->value.f) <= 1e-9 * fmax(1.0, fabs(b->value.f));
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_ELEMENTS;
+    if (n == 0) {
+        fprintf(stderr, "Usage: %s [elements]\n", argv[0]);
+        return 2;
+    }
+    re_hist_spec_t spec = { HIST_BINS, -VALUE_RANGE / 2.0, VALUE_RANGE / 2.0 };
+    long long *ref_bins = (long long *)malloc(sizeof(long long) * HIST_BINS);
+    long long *bins = (long long *)malloc(sizeof(long long) * HIST_BINS);
+    if (!ref_bins || !bins) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+
+    printf("Reduction Engine - Type/Operator/Strategy Matrix\n");
+    printf("Elements: %zu, threads: %d, SIMD ISA: %s\n\n", n, omp_get_max_threads(), simd_isa_name(simd_isa_select()));
+    printf("%-7s %-10s %-11s %12s %10s %9s %s\n", "Type", "Op", "Strategy", "Median (s)", "Melem/s", "GB/s", "Check");
+
+    int failures = 0;
+    for (int t = 0; t < RE_TYPE_COUNT; ++t) {
+        re_type_t type = (re_type_t)t;
+        if (!selected("RE_TYPES", re_type_name(type))) continue;
+        void *data = make_data(type, n);
+        if (!data) {
+            printf("Memory allocation failed!\n");
+            return 1;
+        }
+        for (int o = 0; o < RE_OP_COUNT; ++o) {
+            re_op_t op = (re_op_t)o;
+            if (!selected("RE_OPS", re_op_name(op))) continue;
+            re_result_t reference = { { 0 }, ref_bins };
+            if (re_run(type, op, RE_SEQUENTIAL, data, n, &spec, &reference) != 0) {
+                printf("Memory allocation failed!\n");
+                return 1;
+            }
+            for (int s = 0; s < RE_STRATEGY_COUNT; ++s) {
+                re_strategy_t strategy = (re_strategy_t)s;
+                if (!selected("RE_STRATEGIES", re_strategy_name(strategy))) continue;
+                cell_ctx_t ctx = { type, op, strategy, data, n, &spec, { { 0 }, bins }, 0 };
+                bench_samples_t samples;
+                run_cell(&ctx);
+                if (ctx.status == 1) {
+                    printf("%-7s %-10s %-11s %12s\n", re_type_name(type), re_op_name(op), re_strategy_name(strategy), "n/a");
+                    continue;
+                }
+                if (ctx.status != 0 || bench_run(run_cell, &ctx, &samples) != 0) {
+                    printf("Memory allocation failed!\n");
+                    return 1;
+                }
+                int ok = same_result(type, op, &ctx.result, &reference, HIST_BINS);
+                failures += !ok;
+                printf("%-7s %-10s %-11s %12.6f %10.1f %9.2f %s\n", re_type_name(type), re_op_name(op),
+                       re_strategy_name(strategy), samples.median, n / samples.median / 1e6,
+                       n * re_type_size(type) / samples.median / 1e9, ok ? "✓" : "✗");
+                bench_free(&samples);
+            }
+        }
+        free(data);
+    }
+
+    printf("\n%s\n", failures == 0 ? "✓ All strategies agree with the sequential reference"
+                                   : "✗ Some strategies disagree with the sequential reference");
+    free(ref_bins);
+    free(bins);
+    return failures == 0 ? 0 : 1;
+}
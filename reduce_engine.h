@@ -0,0 +1,303 @@
+#ifndef REDUCE_ENGINE_H
+#define REDUCE_ENGINE_H
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "even_count.h"
+#include "simd_isa.h"
+#include "simd_sum.h"
+
+// Typed reduction engine. One macro instantiation per element type
+// generates a specialized function per operator; each function switches on
+// the strategy once, outside the loop, so every (type, op, strategy) triple
+// compiles to its own loop.
+//
+//   types       int8/16/32/64 (accumulated in long long), float/double
+//               (accumulated in double)
+//   operators   sum, count-if (even for integers, > 0 for floating point),
+//               min, max, histogram over [lo, hi) in nbins equal bins
+//   strategies  sequential        one thread
+//               critical          thread-local partial, merged in a critical section
+//               atomic            every element updates the shared result atomically
+//               reduction         OpenMP reduction clause
+//               simd              reduction clause plus `omp simd`; int32 sum and
+//                                 count use the hand-written dispatched kernels
+//               tree              thread-local partial, pairwise combining tree
+//
+// Sizes are runtime. Typed entry points are re_<op>_<type> (re_sum_i32,
+// re_hist_f64, ...); re_run() dispatches on enums for table-driven drivers.
+// Return value: 0 on success, -1 on allocation failure, 1 when the
+// combination is not supported (histogram has no simd strategy).
+
+#define RE_CACHE_LINE 64
+
+typedef enum { RE_I8, RE_I16, RE_I32, RE_I64, RE_F32, RE_F64, RE_TYPE_COUNT } re_type_t;
+typedef enum { RE_OP_SUM, RE_OP_COUNT_IF, RE_OP_MIN, RE_OP_MAX, RE_OP_HISTOGRAM, RE_OP_COUNT } re_op_t;
+typedef enum { RE_SEQUENTIAL, RE_CRITICAL, RE_ATOMIC, RE_REDUCTION, RE_SIMD, RE_TREE, RE_STRATEGY_COUNT } re_strategy_t;
+
+typedef struct {
+    int nbins;
+    double lo;
+    double hi;
+} re_hist_spec_t;
+
+typedef union {
+    long long i;   // integer element types, and every count
+    double f;      // floating-point element types
+} re_scalar_t;
+
+typedef struct {
+    re_scalar_t value;
+    long long *bins;   // caller-provided, spec->nbins entries, histogram only
+} re_result_t;
+
+static inline const char *re_type_name(re_type_t t) {
+    static const char *names[] = { "int8", "int16", "int32", "int64", "float", "double" };
+    return t < RE_TYPE_COUNT ? names[t] : "?";
+}
+
+static inline const char *re_op_name(re_op_t op) {
+    static const char *names[] = { "sum", "count-if", "min", "max", "histogram" };
+    return op < RE_OP_COUNT ? names[op] : "?";
+}
+
+static inline const char *re_strategy_name(re_strategy_t s) {
+    static const char *names[] = { "sequential", "critical", "atomic", "reduction", "simd", "tree" };
+    return s < RE_STRATEGY_COUNT ? names[s] : "?";
+}
+
+static inline size_t re_type_size(re_type_t t) {
+    static const size_t sizes[] = { 1, 2, 4, 8, 4, 8 };
+    return t < RE_TYPE_COUNT ? sizes[t] : 0;
+}
+
+static inline int re_type_is_float(re_type_t t) { return t == RE_F32 || t == RE_F64; }
+
+#define RE_STR_(x) #x
+#define RE_STR(x) RE_STR_(x)
+#define RE_PRAGMA(x) _Pragma(RE_STR(x))
+
+// Per-operator element steps and merges. STEP folds one element into an
+// accumulator, COMBINE folds a partial into another, ATOMIC folds one
+// element into a shared accumulator.
+#define RE_STEP_SUM(acc, x) ((acc) += (x))
+#define RE_ATOMIC_SUM(p, x) do { RE_PRAGMA(omp atomic) *(p) += (x); } while (0)
+
+#define RE_STEP_COUNT_EVEN(acc, x) ((acc) += (((x) & 1) == 0))
+#define RE_ATOMIC_COUNT_EVEN(p, x) do { if (((x) & 1) == 0) { RE_PRAGMA(omp atomic) (*(p))++; } } while (0)
+#define RE_STEP_COUNT_POSITIVE(acc, x) ((acc) += ((x) > 0))
+#define RE_ATOMIC_COUNT_POSITIVE(p, x) do { if ((x) > 0) { RE_PRAGMA(omp atomic) (*(p))++; } } while (0)
+
+#define RE_STEP_MIN(acc, x) ((acc) = (x) < (acc) ? (x) : (acc))
+#define RE_STEP_MAX(acc, x) ((acc) = (x) > (acc) ? (x) : (acc))
+// Compare-and-swap only while the element still improves the shared value,
+// so most elements cost one relaxed load.
+#define RE_ATOMIC_EXTREMUM(p, x, BETTER) do {                                               \
+    __typeof__(*(p)) v_ = (x), cur_;                                                        \
+    __atomic_load((p), &cur_, __ATOMIC_RELAXED);                                            \
+    while (v_ BETTER cur_ &&                                                                \
+           !__atomic_compare_exchange((p), &cur_, &v_, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) { } \
+} while (0)
+#define RE_ATOMIC_MIN(p, x) RE_ATOMIC_EXTREMUM(p, x, <)
+#define RE_ATOMIC_MAX(p, x) RE_ATOMIC_EXTREMUM(p, x, >)
+
+// One scalar reduction re_<name>(a, n, strategy, &out).
+#define RE_DEFINE_REDUCE(name, T, ACC, IDENTITY, STEP, COMBINE, ATOMIC, OMP_OP)                  \
+typedef struct { _Alignas(RE_CACHE_LINE) ACC v; } re_pad_##name##_t;                              \
+static inline int re_##name(const T *a, size_t n, re_strategy_t strategy, ACC *out) {            \
+    ACC total = IDENTITY;                                                                         \
+    switch (strategy) {                                                                           \
+    case RE_SEQUENTIAL:                                                                           \
+        for (size_t i = 0; i < n; ++i) STEP(total, a[i]);                                         \
+        break;                                                                                    \
+    case RE_CRITICAL:                                                                             \
+        RE_PRAGMA(omp parallel)                                                                   \
+        {                                                                                         \
+            ACC local = IDENTITY;                                                                 \
+            RE_PRAGMA(omp for schedule(static) nowait)                                            \
+            for (size_t i = 0; i < n; ++i) STEP(local, a[i]);                                     \
+            RE_PRAGMA(omp critical)                                                               \
+            COMBINE(total, local);                                                                \
+        }                                                                                         \
+        break;                                                                                    \
+    case RE_ATOMIC:                                                                               \
+        RE_PRAGMA(omp parallel for schedule(static))                                              \
+        for (size_t i = 0; i < n; ++i) ATOMIC(&total, a[i]);                                      \
+        break;                                                                                    \
+    case RE_REDUCTION:                                                                            \
+        RE_PRAGMA(omp parallel for reduction(OMP_OP:total) schedule(static))                      \
+        for (size_t i = 0; i < n; ++i) STEP(total, a[i]);                                         \
+        break;                                                                                    \
+    case RE_SIMD:                                                                                 \
+        RE_PRAGMA(omp parallel for simd reduction(OMP_OP:total) schedule(static))                 \
+        for (size_t i = 0; i < n; ++i) STEP(total, a[i]);                                         \
+        break;                                                                                    \
+    case RE_TREE: {                                                                               \
+        re_pad_##name##_t *parts = (re_pad_##name##_t *)aligned_alloc(RE_CACHE_LINE,              \
+            sizeof(re_pad_##name##_t) * (size_t)omp_get_max_threads());                           \
+        if (!parts) return -1;                                                                    \
+        RE_PRAGMA(omp parallel)                                                                   \
+        {                                                                                         \
+            int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();                     \
+            ACC local = IDENTITY;                                                                 \
+            RE_PRAGMA(omp for schedule(static) nowait)                                            \
+            for (size_t i = 0; i < n; ++i) STEP(local, a[i]);                                     \
+            parts[tid].v = local;                                                                 \
+            for (int stride = 1; stride < nthreads; stride *= 2) {                                \
+                RE_PRAGMA(omp barrier)                                                            \
+                if (tid % (2 * stride) == 0 && tid + stride < nthreads) {                         \
+                    COMBINE(parts[tid].v, parts[tid + stride].v);                                 \
+                }                                                                                 \
+            }                                                                                     \
+        }                                                                                         \
+        total = parts[0].v;                                                                       \
+        free(parts);                                                                              \
+        break;                                                                                    \
+    }                                                                                             \
+    default:                                                                                      \
+        return 1;                                                                                 \
+    }                                                                                             \
+    *out = total;                                                                                 \
+    return 0;                                                                                     \
+}
+
+static inline int re_bin(double x, const re_hist_spec_t *spec, double scale) {
+    double pos = (x - spec->lo) * scale;
+    if (!(pos >= 0)) return 0;   // also catches NaN
+    int b = (int)pos;
+    return b < spec->nbins ? b : spec->nbins - 1;
+}
+
+// re_hist_<tag>(a, n, strategy, spec, bins): bins are overwritten. Values
+// outside [lo, hi) land in the first or last bin.
+#define RE_DEFINE_HISTOGRAM(tag, T)                                                               \
+static inline int re_hist_##tag(const T *a, size_t n, re_strategy_t strategy,                     \
+                                const re_hist_spec_t *spec, long long *bins) {                    \
+    const int nb = spec->nbins;                                                                   \
+    const double scale = nb / (spec->hi - spec->lo);                                              \
+    const int stride = (int)((nb + 7) / 8 * 8);   /* whole cache lines per thread */             \
+    long long *parts = NULL;                                                                      \
+    memset(bins, 0, sizeof(long long) * (size_t)nb);                                              \
+    if (strategy == RE_CRITICAL || strategy == RE_TREE) {                                         \
+        parts = (long long *)aligned_alloc(RE_CACHE_LINE,                                         \
+            sizeof(long long) * (size_t)stride * (size_t)omp_get_max_threads());                  \
+        if (!parts) return -1;                                                                    \
+    }                                                                                             \
+    switch (strategy) {                                                                           \
+    case RE_SEQUENTIAL:                                                                           \
+        for (size_t i = 0; i < n; ++i) bins[re_bin((double)a[i], spec, scale)]++;                 \
+        break;                                                                                    \
+    case RE_CRITICAL:                                                                             \
+        RE_PRAGMA(omp parallel)                                                                   \
+        {                                                                                         \
+            long long *local = parts + (size_t)omp_get_thread_num() * stride;                     \
+            memset(local, 0, sizeof(long long) * (size_t)nb);                                     \
+            RE_PRAGMA(omp for schedule(static) nowait)                                            \
+            for (size_t i = 0; i < n; ++i) local[re_bin((double)a[i], spec, scale)]++;            \
+            RE_PRAGMA(omp critical)                                                               \
+            for (int b = 0; b < nb; ++b) bins[b] += local[b];                                     \
+        }                                                                                         \
+        break;                                                                                    \
+    case RE_ATOMIC:                                                                               \
+        RE_PRAGMA(omp parallel for schedule(static))                                              \
+        for (size_t i = 0; i < n; ++i) {                                                          \
+            int b = re_bin((double)a[i], spec, scale);                                            \
+            RE_PRAGMA(omp atomic)                                                                 \
+            bins[b]++;                                                                            \
+        }                                                                                         \
+        break;                                                                                    \
+    case RE_REDUCTION:                                                                            \
+        RE_PRAGMA(omp parallel for reduction(+:bins[:nb]) schedule(static))                       \
+        for (size_t i = 0; i < n; ++i) bins[re_bin((double)a[i], spec, scale)]++;                 \
+        break;                                                                                    \
+    case RE_TREE:                                                                                 \
+        RE_PRAGMA(omp parallel)                                                                   \
+        {                                                                                         \
+            int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();                     \
+            long long *local = parts + (size_t)tid * stride;                                      \
+            memset(local, 0, sizeof(long long) * (size_t)nb);                                     \
+            RE_PRAGMA(omp for schedule(static) nowait)                                            \
+            for (size_t i = 0; i < n; ++i) local[re_bin((double)a[i], spec, scale)]++;            \
+            for (int step = 1; step < nthreads; step *= 2) {                                      \
+                RE_PRAGMA(omp barrier)                                                            \
+                if (tid % (2 * step) == 0 && tid + step < nthreads) {                             \
+                    const long long *other = parts + (size_t)(tid + step) * stride;               \
+                    for (int b = 0; b < nb; ++b) local[b] += other[b];                            \
+                }                                                                                 \
+            }                                                                                     \
+        }                                                                                         \
+        memcpy(bins, parts, sizeof(long long) * (size_t)nb);                                      \
+        break;                                                                                    \
+    default:                                                                                      \
+        return 1;   /* bin conflicts leave nothing for simd to do */                             \
+    }                                                                                             \
+    free(parts);                                                                                  \
+    return 0;                                                                                     \
+}
+
+#define RE_COMBINE_SUM(acc, other) ((acc) += (other))
+
+#define RE_DEFINE_INT_TYPE(tag, T)                                                                                  \
+    RE_DEFINE_REDUCE(sum_##tag, T, long long, 0, RE_STEP_SUM, RE_COMBINE_SUM, RE_ATOMIC_SUM, +)                    \
+    RE_DEFINE_REDUCE(count_##tag, T, long long, 0, RE_STEP_COUNT_EVEN, RE_COMBINE_SUM, RE_ATOMIC_COUNT_EVEN, +)    \
+    RE_DEFINE_REDUCE(min_##tag, T, long long, LLONG_MAX, RE_STEP_MIN, RE_STEP_MIN, RE_ATOMIC_MIN, min)             \
+    RE_DEFINE_REDUCE(max_##tag, T, long long, LLONG_MIN, RE_STEP_MAX, RE_STEP_MAX, RE_ATOMIC_MAX, max)             \
+    RE_DEFINE_HISTOGRAM(tag, T)
+
+#define RE_DEFINE_FLOAT_TYPE(tag, T)                                                                                \
+    RE_DEFINE_REDUCE(sum_##tag, T, double, 0.0, RE_STEP_SUM, RE_COMBINE_SUM, RE_ATOMIC_SUM, +)                     \
+    RE_DEFINE_REDUCE(count_##tag, T, long long, 0, RE_STEP_COUNT_POSITIVE, RE_COMBINE_SUM, RE_ATOMIC_COUNT_POSITIVE, +) \
+    RE_DEFINE_REDUCE(min_##tag, T, double, INFINITY, RE_STEP_MIN, RE_STEP_MIN, RE_ATOMIC_MIN, min)                 \
+    RE_DEFINE_REDUCE(max_##tag, T, double, -INFINITY, RE_STEP_MAX, RE_STEP_MAX, RE_ATOMIC_MAX, max)                \
+    RE_DEFINE_HISTOGRAM(tag, T)
+
+RE_DEFINE_INT_TYPE(i8, int8_t)
+RE_DEFINE_INT_TYPE(i16, int16_t)
+RE_DEFINE_INT_TYPE(i32, int32_t)
+RE_DEFINE_INT_TYPE(i64, int64_t)
+RE_DEFINE_FLOAT_TYPE(f32, float)
+RE_DEFINE_FLOAT_TYPE(f64, double)
+
+// The hand-tuned int32 kernels from simd_sum.h / even_count.h replace the
+// generic `omp simd` loop for the two operations the drivers time most.
+static inline int re_simd_i32(re_op_t op, const int32_t *a, size_t n, long long *out) {
+    simd_isa_t isa = simd_isa_select();
+    if (op == RE_OP_SUM) *out = sum_i32_parallel(sum_kernel_for(isa), a, n);
+    else *out = sum_i32_parallel(even_count_simd_for(isa), a, n);
+    return 0;
+}
+
+#define RE_DISPATCH_TYPE(ENUM, tag, T, FIELD)                                                     \
+    case ENUM:                                                                                    \
+        switch (op) {                                                                             \
+        case RE_OP_SUM:       return re_sum_##tag((const T *)data, n, strategy, &out->value.FIELD); \
+        case RE_OP_COUNT_IF:  return re_count_##tag((const T *)data, n, strategy, &out->value.i); \
+        case RE_OP_MIN:       return re_min_##tag((const T *)data, n, strategy, &out->value.FIELD); \
+        case RE_OP_MAX:       return re_max_##tag((const T *)data, n, strategy, &out->value.FIELD); \
+        case RE_OP_HISTOGRAM: return re_hist_##tag((const T *)data, n, strategy, spec, out->bins); \
+        default:              return 1;                                                           \
+        }
+
+// Type-erased entry point; `spec` is only read for RE_OP_HISTOGRAM.
+static inline int re_run(re_type_t type, re_op_t op, re_strategy_t strategy, const void *data, size_t n,
+                         const re_hist_spec_t *spec, re_result_t *out) {
+    if (type == RE_I32 && strategy == RE_SIMD && (op == RE_OP_SUM || op == RE_OP_COUNT_IF)) {
+        return re_simd_i32(op, (const int32_t *)data, n, &out->value.i);
+    }
+    switch (type) {
+    RE_DISPATCH_TYPE(RE_I8, i8, int8_t, i)
+    RE_DISPATCH_TYPE(RE_I16, i16, int16_t, i)
+    RE_DISPATCH_TYPE(RE_I32, i32, int32_t, i)
+    RE_DISPATCH_TYPE(RE_I64, i64, int64_t, i)
+    RE_DISPATCH_TYPE(RE_F32, f32, float, f)
+    RE_DISPATCH_TYPE(RE_F64, f64, double, f)
+    default:
+        return 1;
+    }
+}
+
+#endif
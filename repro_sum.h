@@ -0,0 +1,176 @@
+#ifndef REPRO_SUM_H
+#define REPRO_SUM_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+// Reproducible floating-point summation: results that are bit-identical for
+// any schedule, chunk size and thread count.
+//
+//   repro_acc_t          exact superaccumulator. Every double is added as a
+//                        fixed-point integer spanning the whole exponent range,
+//                        so addition is associative and the order of the
+//                        terms cannot matter. The result is the exact sum
+//                        rounded once. Drops into any loop through the
+//                        `repro_add` OpenMP reduction.
+//   repro_sum_blocked    fixed-shape summation of an array: each
+//                        REPRO_BLOCK-element block is summed left to right,
+//                        then the block sums are combined in a fixed pairwise
+//                        tree. Only the block loop is parallel, so the
+//                        operation order never depends on the team. Needs the
+//                        terms in an array, indexed by iteration.
+//
+// Compensated sums (Kahan, Neumaier) are more accurate but still depend on
+// the order of the terms, so neither is offered here.
+
+#ifndef REPRO_BLOCK
+#define REPRO_BLOCK 1024
+#endif
+
+// Digit k holds bits [32k, 32k + 32) of the value in units of 2^-1074
+// (the smallest subnormal). 67 digits cover the largest finite double plus
+// 2^64 of headroom for carries out of the top digit.
+#define REPRO_DIGITS 67
+#define REPRO_DIGIT_BITS 32
+#define REPRO_NORMALIZE_EVERY (1 << 30)   // adds before a digit could overflow
+
+typedef struct {
+    int64_t digit[REPRO_DIGITS];
+    int32_t pending;   // adds since the last carry propagation
+    int32_t special;   // bit 0: +inf seen, bit 1: -inf seen, bit 2: NaN seen
+} repro_acc_t;
+
+static inline void repro_acc_init(repro_acc_t *acc) {
+    memset(acc, 0, sizeof(*acc));
+}
+
+// Carry propagation: every digit but the top one ends up in [0, 2^32).
+static inline void repro_acc_normalize(repro_acc_t *acc) {
+    int64_t carry = 0;
+    for (int k = 0; k < REPRO_DIGITS - 1; ++k) {
+        int64_t d = acc->digit[k] + carry;
+        carry = d >> REPRO_DIGIT_BITS;   // arithmetic shift: floor division
+        acc->digit[k] = d - carry * ((int64_t)1 << REPRO_DIGIT_BITS);
+    }
+    acc->digit[REPRO_DIGITS - 1] += carry;
+    acc->pending = 0;
+}
+
+static inline void repro_acc_add(repro_acc_t *acc, double x) {
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int exponent = (int)((bits >> 52) & 0x7ff);
+    uint64_t mantissa = bits & ((UINT64_C(1) << 52) - 1);
+    int negative = (int)(bits >> 63);
+
+    if (exponent == 0x7ff) {
+        acc->special |= mantissa ? 4 : (negative ? 2 : 1);
+        return;
+    }
+    if (exponent == 0) {
+        if (mantissa == 0) return;
+        exponent = 1;                        // subnormal: same scale as the smallest normal
+    } else {
+        mantissa |= UINT64_C(1) << 52;
+    }
+    int shift = exponent - 1;                // value = mantissa * 2^(shift - 1074)
+    int k = shift / REPRO_DIGIT_BITS;
+    unsigned __int128 v = (unsigned __int128)mantissa << (shift % REPRO_DIGIT_BITS);
+    int64_t d0 = (int64_t)(uint32_t)v;
+    int64_t d1 = (int64_t)(uint32_t)(v >> 32);
+    int64_t d2 = (int64_t)(uint32_t)(v >> 64);
+    if (negative) { d0 = -d0; d1 = -d1; d2 = -d2; }
+    acc->digit[k] += d0;
+    acc->digit[k + 1] += d1;
+    acc->digit[k + 2] += d2;
+    if (++acc->pending >= REPRO_NORMALIZE_EVERY) repro_acc_normalize(acc);
+}
+
+static inline void repro_acc_merge(repro_acc_t *into, const repro_acc_t *from) {
+    repro_acc_t tmp = *from;
+    repro_acc_normalize(into);
+    repro_acc_normalize(&tmp);
+    for (int k = 0; k < REPRO_DIGITS; ++k) into->digit[k] += tmp.digit[k];
+    into->pending = 1;
+    into->special |= tmp.special;
+}
+
+// Round the exact sum to the nearest double (ties to even). Sums that land
+// in the subnormal range may be rounded twice; every term here is far above it.
+static inline double repro_acc_value(const repro_acc_t *acc_in) {
+    if (acc_in->special & 4 || (acc_in->special & 3) == 3) return NAN;
+    if (acc_in->special & 1) return INFINITY;
+    if (acc_in->special & 2) return -INFINITY;
+
+    repro_acc_t acc = *acc_in;
+    repro_acc_normalize(&acc);
+    int negative = acc.digit[REPRO_DIGITS - 1] < 0;
+    if (negative) {   // two's-complement negate across the digits
+        int64_t borrow = 0;
+        for (int k = 0; k < REPRO_DIGITS; ++k) acc.digit[k] = -acc.digit[k];
+        for (int k = 0; k < REPRO_DIGITS - 1; ++k) {
+            int64_t d = acc.digit[k] + borrow;
+            borrow = d >> REPRO_DIGIT_BITS;
+            acc.digit[k] = d - borrow * ((int64_t)1 << REPRO_DIGIT_BITS);
+        }
+        acc.digit[REPRO_DIGITS - 1] += borrow;
+    }
+
+    int top = REPRO_DIGITS - 1;
+    while (top >= 0 && acc.digit[top] == 0) top--;
+    if (top < 0) return 0.0;
+
+    // Take the top 64 significant bits; any bit below them only matters as
+    // a sticky bit for rounding, and it sits below the rounding position.
+    unsigned __int128 window = 0;
+    for (int k = top; k >= top - 2; --k) {
+        window = (window << REPRO_DIGIT_BITS) | (uint32_t)(k >= 0 ? acc.digit[k] : 0);
+    }
+    int lead = 95;                           // window holds 96 bits, the top digit is non-zero
+    while (!((window >> lead) & 1)) lead--;
+    int drop = lead - 63;                    // >= 1: bits below the top 64
+    uint64_t head = (uint64_t)(window >> drop);
+    int sticky = (window & (((unsigned __int128)1 << drop) - 1)) != 0;
+    for (int k = top - 3; k >= 0 && !sticky; --k) sticky = acc.digit[k] != 0;
+    if (sticky) head |= 1;
+
+    int scale = (top - 2) * REPRO_DIGIT_BITS + drop - 1074;
+    double value = ldexp((double)head, scale);
+    return negative ? -value : value;
+}
+
+#pragma omp declare reduction(repro_add : repro_acc_t : repro_acc_merge(&omp_out, &omp_in)) \
+    initializer(repro_acc_init(&omp_priv))
+
+// Fixed-shape pairwise combination of partial sums (in place).
+static inline double repro_pairwise(double *partials, size_t count) {
+    if (count == 0) return 0.0;
+    for (size_t width = 1; width < count; width *= 2) {
+        for (size_t k = 0; k + width < count; k += 2 * width) partials[k] += partials[k + width];
+    }
+    return partials[0];
+}
+
+// The block loop runs under `schedule(runtime)`, so callers can vary the
+// schedule to check the result does not change. Returns NAN if the block
+// buffer cannot be allocated.
+static inline double repro_sum_blocked(const double *v, size_t n) {
+    size_t blocks = (n + REPRO_BLOCK - 1) / REPRO_BLOCK;
+    double *partials = (double *)malloc(sizeof(double) * (blocks ? blocks : 1));
+    if (!partials) return NAN;
+    #pragma omp parallel for schedule(runtime)
+    for (size_t b = 0; b < blocks; ++b) {
+        size_t end = (b + 1) * REPRO_BLOCK < n ? (b + 1) * REPRO_BLOCK : n;
+        double s = 0.0;
+        for (size_t i = b * REPRO_BLOCK; i < end; ++i) s += v[i];
+        partials[b] = s;
+    }
+    double total = repro_pairwise(partials, blocks);
+    free(partials);
+    return total;
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef RESULT_EMIT_H
+#define RESULT_EMIT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <omp.h>
+#include "bench_harness.h"
+#include "host_info.h"
+
+// Machine-readable result records, as JSON lines or CSV.
+//
+// JSON lines: one object per line, every object carrying
+//   "schema": EMIT_SCHEMA, "type": "host" | "result", "run_id": <string>
+// host    cpu_model, logical_cpus, max_threads, compiler, build_flags,
+//         openmp_runtime, omp_proc_bind, omp_places, timestamp (UTC)
+// result  bench, variant, size, threads, reps, warmup, median_s, p5_s,
+//         p95_s, min_s, melem_s, gbs (0 when no bytes are streamed),
+//         check ("ok" | "fail" | "n/a"), params {name: number, ...}
+//
+// CSV: the host record as "# key: value" comment lines, then a header and
+// one row per result with the params folded into "name=value;..." form.
+
+#define EMIT_SCHEMA "openmp-suite/1"
+#define EMIT_MAX_PARAMS 8
+
+typedef enum { EMIT_JSONL, EMIT_CSV } emit_format_t;
+
+typedef struct {
+    FILE *out;
+    emit_format_t format;
+    char run_id[32];
+    int header_done;
+} emit_t;
+
+typedef struct {
+    const char *name;
+    double value;
+} emit_param_t;
+
+typedef struct {
+    const char *bench;
+    const char *variant;
+    long long size;
+    int threads;
+    const bench_samples_t *samples;
+    double elements;   // per run, for melem_s
+    double bytes;      // per run, for gbs
+    int check;         // 1 ok, 0 fail, -1 not checked
+    emit_param_t params[EMIT_MAX_PARAMS];
+    int nparams;
+} emit_result_t;
+
+// path NULL or "-" writes to stdout. Returns 0, or -1 if the file cannot
+// be opened.
+static inline int emit_open(emit_t *e, const char *path, emit_format_t format) {
+    memset(e, 0, sizeof(*e));
+    e->format = format;
+    e->out = !path || strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!e->out) return -1;
+    snprintf(e->run_id, sizeof(e->run_id), "%lld-%d", (long long)time(NULL), (int)getpid());
+    return 0;
+}
+
+static inline void emit_close(emit_t *e) {
+    if (e->out && e->out != stdout) fclose(e->out);
+    else if (e->out) fflush(e->out);
+    e->out = NULL;
+}
+
+static inline void emit_json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20) fprintf(out, "\\u%04x", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+static inline void emit_host(emit_t *e) {
+    char cpu[256], runtime[64], stamp[32];
+    host_cpu_model(cpu, sizeof(cpu));
+    host_openmp_runtime(runtime, sizeof(runtime));
+    time_t now = time(NULL);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    const char *bind = getenv("OMP_PROC_BIND"), *places = getenv("OMP_PLACES");
+    const char *keys[] = { "cpu_model", "compiler", "build_flags", "openmp_runtime", "omp_proc_bind", "omp_places",
+                           "timestamp" };
+    const char *values[] = { cpu, host_compiler(), host_build_flags(), runtime, bind ? bind : "", places ? places : "",
+                             stamp };
+    const int nkeys = (int)(sizeof(keys) / sizeof(keys[0]));
+
+    if (e->format == EMIT_CSV) {
+        fprintf(e->out, "# schema: %s\n# run_id: %s\n# logical_cpus: %d\n# max_threads: %d\n", EMIT_SCHEMA, e->run_id,
+                omp_get_num_procs(), omp_get_max_threads());
+        for (int k = 0; k < nkeys; ++k) fprintf(e->out, "# %s: %s\n", keys[k], values[k]);
+        return;
+    }
+    fprintf(e->out, "{\"schema\":\"%s\",\"type\":\"host\",\"run_id\":\"%s\",\"logical_cpus\":%d,\"max_threads\":%d",
+            EMIT_SCHEMA, e->run_id, omp_get_num_procs(), omp_get_max_threads());
+    for (int k = 0; k < nkeys; ++k) {
+        fprintf(e->out, ",\"%s\":", keys[k]);
+        emit_json_string(e->out, values[k]);
+    }
+    fprintf(e->out, "}\n");
+    fflush(e->out);
+}
+
+static inline void emit_result(emit_t *e, const emit_result_t *r) {
+    const bench_samples_t *s = r->samples;
+    double min = s->reps ? s->times[0] : 0.0;
+    for (int i = 1; i < s->reps; ++i) if (s->times[i] < min) min = s->times[i];
+    double melem = s->median > 0 ? r->elements / s->median / 1e6 : 0.0;
+    double gbs = s->median > 0 ? r->bytes / s->median / 1e9 : 0.0;
+    const char *check = r->check < 0 ? "n/a" : r->check ? "ok" : "fail";
+
+    if (e->format == EMIT_CSV) {
+        if (!e->header_done) {
+            fprintf(e->out, "run_id,bench,variant,size,threads,reps,warmup,median_s,p5_s,p95_s,min_s,melem_s,gbs,"
+                            "check,params\n");
+            e->header_done = 1;
+        }
+        fprintf(e->out, "%s,%s,%s,%lld,%d,%d,%d,%.9f,%.9f,%.9f,%.9f,%.3f,%.3f,%s,", e->run_id, r->bench, r->variant,
+                r->size, r->threads, s->reps, s->warmup, s->median, s->p5, s->p95, min, melem, gbs, check);
+        for (int p = 0; p < r->nparams; ++p) fprintf(e->out, "%s%s=%.17g", p ? ";" : "", r->params[p].name, r->params[p].value);
+        fprintf(e->out, "\n");
+        fflush(e->out);
+        return;
+    }
+    fprintf(e->out, "{\"schema\":\"%s\",\"type\":\"result\",\"run_id\":\"%s\",\"bench\":", EMIT_SCHEMA, e->run_id);
+    emit_json_string(e->out, r->bench);
+    fprintf(e->out, ",\"variant\":");
+    emit_json_string(e->out, r->variant);
+    fprintf(e->out, ",\"size\":%lld,\"threads\":%d,\"reps\":%d,\"warmup\":%d,\"median_s\":%.9f,\"p5_s\":%.9f,"
+                    "\"p95_s\":%.9f,\"min_s\":%.9f,\"melem_s\":%.3f,\"gbs\":%.3f,\"check\":\"%s\",\"params\":{",
+            r->size, r->threads, s->reps, s->warmup, s->median, s->p5, s->p95, min, melem, gbs, check);
+    for (int p = 0; p < r->nparams; ++p) {
+        fprintf(e->out, "%s", p ? "," : "");
+        emit_json_string(e->out, r->params[p].name);
+        fprintf(e->out, ":%.17g", r->params[p].value);
+    }
+    fprintf(e->out, "}}\n");
+    fflush(e->out);
+}
+
+#endif
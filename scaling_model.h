@@ -0,0 +1,145 @@
+#ifndef SCALING_MODEL_H
+#define SCALING_MODEL_H
+
+#include <math.h>
+#include <omp.h>
+#include "simd_sum.h"
+
+// Roofline ceilings and scaling-law fits for a thread sweep.
+//
+//   sm_peak_gflops       FP64 FMA peak of the team: independent multiply-add
+//                        chains, enough of them to cover FMA latency on
+//                        every port, compiled once per ISA.
+//   sm_fit_amdahl        serial fraction f of S(p) = 1 / (f + (1 - f) / p)
+//   sm_fit_gustafson     serial fraction a of S(p) = p - a (p - 1)
+//   sm_saturation_index  first point of a bandwidth sweep within a given
+//                        fraction of its maximum
+//
+// Both fits are least squares in a form that is linear in the unknown
+// (1/S - 1/p = f (1 - 1/p) and p - S = a (p - 1)), so they need no solver.
+
+#ifndef SM_TRIALS
+#define SM_TRIALS 3
+#endif
+#ifndef SM_FMA_ITERS
+#define SM_FMA_ITERS (1L << 22)
+#endif
+
+// LANES doubles = 8 registers of the target width: 8 chains in flight.
+#define SM_DEFINE_FMA_KERNEL(suffix, ATTR, LANES)                          \
+ATTR static double sm_fma_block_##suffix(long iters, double *flops) {      \
+    double acc[LANES];                                                     \
+    for (int j = 0; j < LANES; ++j) acc[j] = j * 1e-3;                     \
+    const double a = 0.9999999, b = 1e-9;                                  \
+    for (long r = 0; r < iters; ++r) {                                     \
+        _Pragma("omp simd")                                                \
+        for (int j = 0; j < LANES; ++j) acc[j] = acc[j] * a + b;           \
+    }                                                                      \
+    double s = 0.0;                                                        \
+    for (int j = 0; j < LANES; ++j) s += acc[j];                           \
+    *flops = 2.0 * LANES * (double)iters;                                  \
+    return s;                                                              \
+}
+
+typedef double (*sm_fma_fn)(long iters, double *flops);
+
+SM_DEFINE_FMA_KERNEL(default, , 16)
+#if defined(__x86_64__) || defined(__i386__)
+SM_DEFINE_FMA_KERNEL(avx2, SIMD_TARGET("avx2,fma"), 32)
+SM_DEFINE_FMA_KERNEL(avx512, SIMD_TARGET("avx512f"), 64)
+#endif
+
+// Best of SM_TRIALS with the whole team, in GFLOP/s. *isa_out names the
+// kernel used.
+static inline double sm_peak_gflops(const char **isa_out) {
+    sm_fma_fn kernel = sm_fma_block_default;
+    const char *isa = "default";
+#if defined(__x86_64__) || defined(__i386__)
+    simd_isa_t selected = simd_isa_select();
+    if (selected == ISA_AVX512) {
+        kernel = sm_fma_block_avx512;
+        isa = "avx512";
+    } else if (selected == ISA_AVX2 && __builtin_cpu_supports("fma")) {
+        kernel = sm_fma_block_avx2;
+        isa = "avx2";
+    }
+#endif
+    if (isa_out) *isa_out = isa;
+
+    double best = 0.0;
+    volatile double sink = 0.0;   // keeps the chains live
+    for (int t = 0; t < SM_TRIALS; ++t) {
+        double flops = 0.0, checksum = 0.0;
+        double t0 = omp_get_wtime();
+        #pragma omp parallel reduction(+:flops, checksum)
+        {
+            double mine;
+            checksum += kernel(SM_FMA_ITERS, &mine);
+            flops += mine;
+        }
+        double rate = flops / (omp_get_wtime() - t0) / 1e9;
+        sink = checksum;
+        if (rate > best) best = rate;
+    }
+    (void)sink;
+    return best;
+}
+
+// Fits over points with p > 1 (p = 1 carries no information about f).
+// Return the number of points used; with none, *fraction is 0.
+static inline int sm_fit_amdahl(const int *threads, const double *speedup, int n, double *fraction) {
+    double sxy = 0.0, sxx = 0.0;
+    int used = 0;
+    for (int i = 0; i < n; ++i) {
+        if (threads[i] <= 1 || speedup[i] <= 0.0) continue;
+        double x = 1.0 - 1.0 / threads[i];
+        double y = 1.0 / speedup[i] - 1.0 / threads[i];
+        sxy += x * y;
+        sxx += x * x;
+        used++;
+    }
+    double f = used ? sxy / sxx : 0.0;
+    *fraction = f < 0.0 ? 0.0 : f > 1.0 ? 1.0 : f;
+    return used;
+}
+
+static inline int sm_fit_gustafson(const int *threads, const double *speedup, int n, double *fraction) {
+    double sxy = 0.0, sxx = 0.0;
+    int used = 0;
+    for (int i = 0; i < n; ++i) {
+        if (threads[i] <= 1) continue;
+        double x = threads[i] - 1.0;
+        double y = threads[i] - speedup[i];
+        sxy += x * y;
+        sxx += x * x;
+        used++;
+    }
+    double a = used ? sxy / sxx : 0.0;
+    *fraction = a < 0.0 ? 0.0 : a > 1.0 ? 1.0 : a;
+    return used;
+}
+
+static inline double sm_amdahl(double f, double p) { return 1.0 / (f + (1.0 - f) / p); }
+static inline double sm_gustafson(double a, double p) { return p - a * (p - 1.0); }
+
+// Root-mean-square relative error of a model over the measured points.
+static inline double sm_rms_error(double (*model)(double, double), double fraction, const int *threads,
+                                  const double *speedup, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double e = model(fraction, threads[i]) / speedup[i] - 1.0;
+        sum += e * e;
+    }
+    return n ? sqrt(sum / n) : 0.0;
+}
+
+// Index of the first entry >= fraction * max(values); values follow
+// increasing thread counts.
+static inline int sm_saturation_index(const double *values, int n, double fraction) {
+    double max = 0.0;
+    for (int i = 0; i < n; ++i) if (values[i] > max) max = values[i];
+    for (int i = 0; i < n; ++i) if (values[i] >= fraction * max) return i;
+    return n - 1;
+}
+
+#endif
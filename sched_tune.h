@@ -0,0 +1,224 @@
+#ifndef SCHED_TUNE_H
+#define SCHED_TUNE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "host_info.h"
+
+// Schedule autotuner for loops written with schedule(runtime). It searches
+// schedule kind x chunk size x thread count; st_apply() installs the winner
+// through omp_set_schedule / omp_set_num_threads.
+//
+//   1. For each (kind, thread count), a golden-section search over
+//      log2(chunk) finds that pair's best chunk, one timed run per point.
+//      schedule(static) without a chunk (one block per thread) is an extra
+//      candidate.
+//   2. Successive halving over those winners: every round re-times the
+//      survivors and keeps the faster half (by best time so far), so one
+//      lucky run cannot pick the final configuration.
+//
+// Winners are appended to a small text cache (SCHED_TUNE_CACHE, default
+// sched_tune.cache) keyed by loop id, trip count and a machine fingerprint
+// (CPU model, processor count, OpenMP thread limit). A later run with the
+// same key reuses the entry without timing anything; SCHED_TUNE=retune
+// ignores the cache.
+
+#ifndef ST_MAX_CANDIDATES
+#define ST_MAX_CANDIDATES 512
+#endif
+#define ST_CACHE_DEFAULT "sched_tune.cache"
+
+typedef struct {
+    omp_sched_t kind;
+    int chunk;       // 0: the kind's default chunk
+    int threads;
+    double seconds;  // best time seen for this configuration
+} st_config_t;
+
+typedef struct {
+    st_config_t best;
+    double best_seen;        // fastest single run of any configuration
+    double default_seconds;  // schedule(static) at the full team, if timed (else 0)
+    double tuning_seconds;
+    int evaluations;
+    int from_cache;
+    unsigned long long fingerprint;
+} st_result_t;
+
+// Runs the loop once; it must use schedule(runtime) to pick up the config.
+typedef void (*st_run_fn)(void *arg);
+
+static inline const char *st_kind_name(omp_sched_t kind) {
+    switch (kind) {
+    case omp_sched_static: return "static";
+    case omp_sched_dynamic: return "dynamic";
+    case omp_sched_guided: return "guided";
+    default: return "auto";
+    }
+}
+
+static inline int st_kind_parse(const char *name, omp_sched_t *kind) {
+    if (strcmp(name, "static") == 0) *kind = omp_sched_static;
+    else if (strcmp(name, "dynamic") == 0) *kind = omp_sched_dynamic;
+    else if (strcmp(name, "guided") == 0) *kind = omp_sched_guided;
+    else return -1;
+    return 0;
+}
+
+static inline void st_apply(const st_config_t *cfg) {
+    omp_set_num_threads(cfg->threads);
+    omp_set_schedule(cfg->kind, cfg->chunk);
+}
+
+static inline unsigned long long st_fnv1a(unsigned long long h, const char *s) {
+    for (; *s; ++s) h = (h ^ (unsigned char)*s) * 0x100000001B3ULL;
+    return h;
+}
+
+static inline unsigned long long st_machine_fingerprint(void) {
+    char model[256], counts[64];
+    host_cpu_model(model, sizeof(model));
+    snprintf(counts, sizeof(counts), "|%d|%d", omp_get_num_procs(), omp_get_max_threads());
+    return st_fnv1a(st_fnv1a(0xCBF29CE484222325ULL, model), counts);
+}
+
+static inline const char *st_cache_path(void) {
+    const char *env = getenv("SCHED_TUNE_CACHE");
+    return env && *env ? env : ST_CACHE_DEFAULT;
+}
+
+// Cache lines: <loop id> <n> <fingerprint> <kind> <chunk> <threads> <seconds> <best seen>
+// The last matching line wins, so re-tuning only ever appends.
+static inline int st_cache_lookup(const char *loop_id, long long n, unsigned long long fp, st_result_t *out) {
+    FILE *f = fopen(st_cache_path(), "r");
+    if (!f) return 0;
+    char line[512], id[256], kind[32];
+    long long cn;
+    unsigned long long cfp;
+    int chunk, threads, found = 0;
+    double seconds, best_seen;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%255s %lld %llx %31s %d %d %lf %lf", id, &cn, &cfp, kind, &chunk, &threads, &seconds,
+                   &best_seen) != 8) continue;
+        omp_sched_t k;
+        if (strcmp(id, loop_id) != 0 || cn != n || cfp != fp || st_kind_parse(kind, &k) != 0) continue;
+        st_config_t cfg = { k, chunk, threads, seconds };
+        out->best = cfg;
+        out->best_seen = best_seen;
+        found = 1;
+    }
+    fclose(f);
+    return found;
+}
+
+static inline void st_cache_store(const char *loop_id, long long n, const st_result_t *res) {
+    const char *path = st_cache_path();
+    FILE *probe = fopen(path, "r");
+    int fresh = probe == NULL;
+    if (probe) fclose(probe);
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        fprintf(stderr, "sched_tune: cannot write %s\n", path);
+        return;
+    }
+    if (fresh) fprintf(f, "# loop_id n fingerprint kind chunk threads seconds best_seen\n");
+    fprintf(f, "%s %lld %016llx %s %d %d %.9f %.9f\n", loop_id, n, res->fingerprint, st_kind_name(res->best.kind),
+            res->best.chunk, res->best.threads, res->best.seconds, res->best_seen);
+    fclose(f);
+}
+
+typedef struct {
+    st_run_fn run;
+    void *arg;
+    st_result_t *res;
+} st_search_t;
+
+static inline double st_time(st_search_t *s, st_config_t *cfg) {
+    st_apply(cfg);
+    double t0 = omp_get_wtime();
+    s->run(s->arg);
+    double t = omp_get_wtime() - t0;
+    s->res->evaluations++;
+    if (cfg->seconds == 0.0 || t < cfg->seconds) cfg->seconds = t;
+    if (s->res->best_seen == 0.0 || t < s->res->best_seen) s->res->best_seen = t;
+    return t;
+}
+
+// Golden-section search over chunk = 2^e, e in [0, max_exp]; every exponent
+// is timed at most once.
+static inline st_config_t st_golden_chunk(st_search_t *s, omp_sched_t kind, int threads, int max_exp) {
+    double cost[32];
+    for (int e = 0; e <= max_exp; ++e) cost[e] = -1.0;
+    int lo = 0, hi = max_exp;
+    #define ST_COST(e) (cost[e] >= 0.0 ? cost[e] : (cost[e] = st_time(s, &(st_config_t){ kind, 1 << (e), threads, 0.0 })))
+    while (hi - lo > 2) {
+        int step = (int)((hi - lo) * 0.381966 + 0.5);
+        int m1 = lo + step, m2 = hi - step;
+        if (m2 <= m1) m2 = m1 + 1;
+        if (ST_COST(m1) <= ST_COST(m2)) hi = m2;
+        else lo = m1;
+    }
+    int best = lo;
+    for (int e = lo; e <= hi; ++e) {
+        if (ST_COST(e) < ST_COST(best)) best = e;
+    }
+    #undef ST_COST
+    st_config_t cfg = { kind, 1 << best, threads, cost[best] };
+    return cfg;
+}
+
+static inline int st_cmp_seconds(const void *a, const void *b) {
+    double x = ((const st_config_t *)a)->seconds, y = ((const st_config_t *)b)->seconds;
+    return (x > y) - (x < y);
+}
+
+// Returns 0, or -1 if no configuration could be timed. The thread count is
+// restored afterwards; call st_apply(&res->best) before running the loop.
+static inline int st_tune(const char *loop_id, long long n, st_run_fn run, void *arg, st_result_t *res) {
+    const int max_threads = omp_get_max_threads();
+    double t_start = omp_get_wtime();
+    memset(res, 0, sizeof(*res));
+    res->fingerprint = st_machine_fingerprint();
+
+    const char *mode = getenv("SCHED_TUNE");
+    int retune = mode && strcmp(mode, "retune") == 0;
+    if (!retune && st_cache_lookup(loop_id, n, res->fingerprint, res)) {
+        res->from_cache = 1;
+        res->tuning_seconds = omp_get_wtime() - t_start;
+        return 0;
+    }
+
+    st_config_t finalists[ST_MAX_CANDIDATES];
+    int count = 0;
+    st_search_t search = { run, arg, res };
+    static const omp_sched_t kinds[] = { omp_sched_static, omp_sched_dynamic, omp_sched_guided };
+    for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        int max_exp = 0;
+        while (max_exp < 30 && (2LL << max_exp) <= n / threads) max_exp++;
+        st_config_t block = { omp_sched_static, 0, threads, 0.0 };
+        st_time(&search, &block);
+        if (threads == max_threads) res->default_seconds = block.seconds;
+        if (count < ST_MAX_CANDIDATES) finalists[count++] = block;
+        for (int k = 0; k < 3 && count < ST_MAX_CANDIDATES; ++k) {
+            finalists[count++] = st_golden_chunk(&search, kinds[k], threads, max_exp);
+        }
+        if (threads == max_threads) break;
+    }
+    if (count == 0) return -1;
+
+    while (count > 1) {
+        for (int i = 0; i < count; ++i) st_time(&search, &finalists[i]);
+        qsort(finalists, count, sizeof(st_config_t), st_cmp_seconds);
+        count = (count + 1) / 2;
+    }
+    res->best = finalists[0];
+    st_cache_store(loop_id, n, res);
+    omp_set_num_threads(max_threads);
+    res->tuning_seconds = omp_get_wtime() - t_start;
+    return 0;
+}
+
+#endif
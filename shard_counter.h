@@ -0,0 +1,108 @@
+#ifndef SHARD_COUNTER_H
+#define SHARD_COUNTER_H
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+// Concurrent aggregation without locks, for updates that OpenMP `reduction`
+// cannot express (updates from callbacks, data structures, several
+// counters per element). Three primitives, cheapest first:
+//
+//   sc_slots_t     one counter per thread, each on its own cache line; the
+//                  owner updates with plain stores, totals are read after
+//                  the parallel region
+//   sc_sharded_t   relaxed atomic adds spread over SC_SHARDS padded shards;
+//                  any thread may update any time, totals are approximate
+//                  while updates are in flight
+//   sc_tree_merge  pairwise combining of per-thread partials inside the
+//                  region: log2(team) barrier steps, no lock, no atomics
+//
+// sc_slots_t with stride 1 packs the counters next to each other; it exists
+// only to show what false sharing costs.
+
+#define SC_CACHE_LINE 64
+#ifndef SC_SHARDS
+#define SC_SHARDS 64   // power of two
+#endif
+
+typedef struct {
+    _Alignas(SC_CACHE_LINE) long long value;
+} sc_padded_t;
+
+typedef struct {
+    volatile long long *cells;   // volatile: every update is a store, as with a shared slot
+    int nslots;
+    int stride;                  // in long longs between neighbouring slots
+} sc_slots_t;
+
+typedef struct {
+    _Alignas(SC_CACHE_LINE) atomic_llong value;
+} sc_shard_t;
+
+typedef struct {
+    sc_shard_t shards[SC_SHARDS];
+} sc_sharded_t;
+
+static inline int sc_slots_init(sc_slots_t *s, int nslots, int padded) {
+    s->nslots = nslots;
+    s->stride = padded ? (int)(SC_CACHE_LINE / sizeof(long long)) : 1;
+    size_t bytes = sizeof(long long) * (size_t)nslots * (size_t)s->stride;
+    bytes = (bytes + SC_CACHE_LINE - 1) / SC_CACHE_LINE * SC_CACHE_LINE;
+    long long *cells = (long long *)aligned_alloc(SC_CACHE_LINE, bytes);
+    if (!cells) return -1;
+    memset(cells, 0, bytes);
+    s->cells = cells;
+    return 0;
+}
+
+static inline void sc_slots_add(sc_slots_t *s, int tid, long long v) {
+    s->cells[(size_t)tid * (size_t)s->stride] += v;
+}
+
+static inline long long sc_slots_total(const sc_slots_t *s) {
+    long long total = 0;
+    for (int t = 0; t < s->nslots; ++t) total += s->cells[(size_t)t * (size_t)s->stride];
+    return total;
+}
+
+static inline void sc_slots_free(sc_slots_t *s) {
+    free((void *)s->cells);
+    s->cells = NULL;
+}
+
+static inline void sc_sharded_init(sc_sharded_t *c) {
+    for (int k = 0; k < SC_SHARDS; ++k) atomic_init(&c->shards[k].value, 0);
+}
+
+// Threads on distinct shards never share a line; ids beyond SC_SHARDS wrap.
+static inline void sc_sharded_add(sc_sharded_t *c, int tid, long long v) {
+    atomic_fetch_add_explicit(&c->shards[tid & (SC_SHARDS - 1)].value, v, memory_order_relaxed);
+}
+
+static inline long long sc_sharded_total(sc_sharded_t *c) {
+    long long total = 0;
+    for (int k = 0; k < SC_SHARDS; ++k) total += atomic_load_explicit(&c->shards[k].value, memory_order_relaxed);
+    return total;
+}
+
+// Must be reached by every thread of the team, with `partials` holding
+// omp_get_num_threads() entries. Returns the team total on all threads.
+static inline long long sc_tree_merge(sc_padded_t *partials, long long mine) {
+    int tid = omp_get_thread_num();
+    int nthreads = omp_get_num_threads();
+    partials[tid].value = mine;
+    for (int stride = 1; stride < nthreads; stride *= 2) {
+        #pragma omp barrier
+        if (tid % (2 * stride) == 0 && tid + stride < nthreads) {
+            partials[tid].value += partials[tid + stride].value;
+        }
+    }
+    #pragma omp barrier
+    long long total = partials[0].value;
+    #pragma omp barrier   // partials may be reused right after return
+    return total;
+}
+
+#endif
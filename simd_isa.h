@@ -0,0 +1,65 @@
+#ifndef SIMD_ISA_H
+#define SIMD_ISA_H
+
+#include <stdlib.h>
+#include <string.h>
+
+// Instruction sets the hand-vectorized kernels are written for. Detection
+// happens at runtime (CPUID on x86), so one binary built with plain -O3 runs
+// the widest kernel the machine actually supports.
+typedef enum {
+    ISA_SCALAR = 0,
+    ISA_SSE2,
+    ISA_AVX2,
+    ISA_AVX512,
+    ISA_NEON,
+    ISA_COUNT
+} simd_isa_t;
+
+static inline const char *simd_isa_name(simd_isa_t isa) {
+    switch (isa) {
+        case ISA_SCALAR: return "scalar";
+        case ISA_SSE2:   return "sse2";
+        case ISA_AVX2:   return "avx2";
+        case ISA_AVX512: return "avx512";
+        case ISA_NEON:   return "neon";
+        default:         return "unknown";
+    }
+}
+
+static inline int simd_isa_supported(simd_isa_t isa) {
+    if (isa == ISA_SCALAR) return 1;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    switch (isa) {
+        case ISA_SSE2:   return __builtin_cpu_supports("sse2");
+        case ISA_AVX2:   return __builtin_cpu_supports("avx2");
+        case ISA_AVX512: return __builtin_cpu_supports("avx512f");
+        default:         return 0;
+    }
+#elif defined(__aarch64__)
+    return isa == ISA_NEON;
+#else
+    return 0;
+#endif
+}
+
+// Widest supported ISA, unless SIMD_ISA=<name> in the environment forces one
+// (an unsupported or unknown name falls back to the detected best).
+static inline simd_isa_t simd_isa_select(void) {
+    simd_isa_t best = ISA_SCALAR;
+    for (int i = 0; i < ISA_COUNT; ++i) {
+        if (simd_isa_supported((simd_isa_t)i)) best = (simd_isa_t)i;
+    }
+    const char *forced = getenv("SIMD_ISA");
+    if (forced) {
+        for (int i = 0; i < ISA_COUNT; ++i) {
+            if (strcmp(forced, simd_isa_name((simd_isa_t)i)) == 0 && simd_isa_supported((simd_isa_t)i)) {
+                return (simd_isa_t)i;
+            }
+        }
+    }
+    return best;
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef SIMD_SUM_H
+#define SIMD_SUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <omp.h>
+#include "simd_isa.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Sum kernels over int32 data with 64-bit accumulation. Every kernel widens
+// each element to int64 before adding (sign-extending), so the result is
+// exact for any n that fits in memory. Each one keeps four independent
+// accumulators so the adds are not serialized on a single dependency chain.
+
+typedef long long (*sum_kernel_fn)(const int *a, size_t n);
+
+static inline long long sum_i32_scalar(const int *a, size_t n) {
+    long long s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i];
+        s1 += a[i + 1];
+        s2 += a[i + 2];
+        s3 += a[i + 3];
+    }
+    for (; i < n; ++i) s0 += a[i];
+    return s0 + s1 + s2 + s3;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+SIMD_TARGET("sse2")
+static inline __m128i sse2_widen_add(__m128i acc, __m128i v) {
+    // SSE2 has no pmovsxdq; build the high halves from the sign bits
+    __m128i sign = _mm_srai_epi32(v, 31);
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+    return _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+}
+
+SIMD_TARGET("sse2")
+static inline long long sum_i32_sse2(const int *a, size_t n) {
+    __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+    __m128i acc2 = _mm_setzero_si128(), acc3 = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = sse2_widen_add(acc0, _mm_loadu_si128((const __m128i *)(a + i)));
+        acc1 = sse2_widen_add(acc1, _mm_loadu_si128((const __m128i *)(a + i + 4)));
+        acc2 = sse2_widen_add(acc2, _mm_loadu_si128((const __m128i *)(a + i + 8)));
+        acc3 = sse2_widen_add(acc3, _mm_loadu_si128((const __m128i *)(a + i + 12)));
+    }
+    __m128i acc = _mm_add_epi64(_mm_add_epi64(acc0, acc1), _mm_add_epi64(acc2, acc3));
+    long long lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    return lanes[0] + lanes[1] + sum_i32_scalar(a + i, n - i);
+}
+
+SIMD_TARGET("avx2")
+static inline long long sum_i32_avx2(const int *a, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a + i))));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a + i + 4))));
+        acc2 = _mm256_add_epi64(acc2, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a + i + 8))));
+        acc3 = _mm256_add_epi64(acc3, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(a + i + 12))));
+    }
+    __m256i acc = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_i32_scalar(a + i, n - i);
+}
+
+SIMD_TARGET("avx512f")
+static inline long long sum_i32_avx512(const int *a, size_t n) {
+    __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+    __m512i acc2 = _mm512_setzero_si512(), acc3 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_add_epi64(acc0, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(a + i))));
+        acc1 = _mm512_add_epi64(acc1, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(a + i + 8))));
+        acc2 = _mm512_add_epi64(acc2, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(a + i + 16))));
+        acc3 = _mm512_add_epi64(acc3, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(a + i + 24))));
+    }
+    __m512i acc = _mm512_add_epi64(_mm512_add_epi64(acc0, acc1), _mm512_add_epi64(acc2, acc3));
+    return _mm512_reduce_add_epi64(acc) + sum_i32_scalar(a + i, n - i);
+}
+
+#endif
+
+#if defined(__aarch64__)
+static inline long long sum_i32_neon(const int *a, size_t n) {
+    int64x2_t acc0 = vdupq_n_s64(0), acc1 = vdupq_n_s64(0);
+    int64x2_t acc2 = vdupq_n_s64(0), acc3 = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = vpadalq_s32(acc0, vld1q_s32(a + i));
+        acc1 = vpadalq_s32(acc1, vld1q_s32(a + i + 4));
+        acc2 = vpadalq_s32(acc2, vld1q_s32(a + i + 8));
+        acc3 = vpadalq_s32(acc3, vld1q_s32(a + i + 12));
+    }
+    int64x2_t acc = vaddq_s64(vaddq_s64(acc0, acc1), vaddq_s64(acc2, acc3));
+    return vaddvq_s64(acc) + sum_i32_scalar(a + i, n - i);
+}
+#endif
+
+static inline sum_kernel_fn sum_kernel_for(simd_isa_t isa) {
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        case ISA_SSE2:   return sum_i32_sse2;
+        case ISA_AVX2:   return sum_i32_avx2;
+        case ISA_AVX512: return sum_i32_avx512;
+#endif
+#if defined(__aarch64__)
+        case ISA_NEON:   return sum_i32_neon;
+#endif
+        default:         return sum_i32_scalar;
+    }
+}
+
+// Same split as schedule(static) without a chunk: the first n % nthreads
+// threads get one extra element, so thread t touches the same pages it would
+// under "#pragma omp for schedule(static)".
+static inline void static_range(size_t n, int tid, int nthreads, size_t *lo, size_t *hi) {
+    size_t q = n / (size_t)nthreads;
+    size_t r = n % (size_t)nthreads;
+    size_t t = (size_t)tid;
+    *lo = t * q + (t < r ? t : r);
+    *hi = *lo + q + (t < r ? 1 : 0);
+}
+
+// Runs the kernel on each thread's static slice and combines the partials
+// with an OpenMP reduction.
+static inline long long sum_i32_parallel(sum_kernel_fn kernel, const int *a, size_t n) {
+    long long total = 0;
+    #pragma omp parallel reduction(+:total)
+    {
+        size_t lo, hi;
+        static_range(n, omp_get_thread_num(), omp_get_num_threads(), &lo, &hi);
+        total += kernel(a + lo, hi - lo);
+    }
+    return total;
+}
+
+#endif
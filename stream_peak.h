@@ -0,0 +1,46 @@
+#ifndef STREAM_PEAK_H
+#define STREAM_PEAK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#ifndef STREAM_ELEMENTS
+#define STREAM_ELEMENTS 20000000   // 3 x 160 MB, well past any LLC
+#endif
+#ifndef STREAM_TRIALS
+#define STREAM_TRIALS 5
+#endif
+
+// STREAM triad (a[i] = b[i] + s*c[i]) with the whole team, best of
+// STREAM_TRIALS. Bytes are counted the way STREAM does: two reads and one
+// write per element, no write-allocate traffic. Returns GB/s (1e9), or 0 if
+// the buffers cannot be allocated.
+static inline double stream_peak_gbs(void) {
+    const long n = STREAM_ELEMENTS;
+    double *a = (double *)malloc(sizeof(double) * (size_t)n);
+    double *b = (double *)malloc(sizeof(double) * (size_t)n);
+    double *c = (double *)malloc(sizeof(double) * (size_t)n);
+    if (!a || !b || !c) {
+        free(a); free(b); free(c);
+        return 0.0;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < n; ++i) { a[i] = 0.0; b[i] = 1.0; c[i] = 2.0; }
+
+    const double scalar = 3.0;
+    double best = 1e100;
+    for (int t = 0; t < STREAM_TRIALS; ++t) {
+        double t0 = omp_get_wtime();
+        #pragma omp parallel for schedule(static)
+        for (long i = 0; i < n; ++i) a[i] = b[i] + scalar * c[i];
+        double t1 = omp_get_wtime();
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+
+    free(a); free(b); free(c);
+    return 3.0 * sizeof(double) * (double)n / best / 1e9;
+}
+
+#endif
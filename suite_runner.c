@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <omp.h>
+#include "bench_harness.h"
+#include "datagen.h"
+#include "numa_alloc.h"
+#include "reduce_engine.h"
+#include "result_emit.h"
+#include "uneven_work.h"
+
+// Unified runner for the suite's workloads. Every knob that the part*
+// programs fix with #define is a run-time option here, and one invocation
+// sweeps benches x sizes x threads x variants, emitting one record per
+// point (see result_emit.h for the schema).
+//
+//   ./suite_runner [--key=value ...]
+//
+// Each option can also come from the environment as SUITE_<KEY> (upper
+// case, '-' -> '_'); the command line wins. Lists are comma-separated and
+// sizes take K/M/G suffixes (powers of 1000).
+//
+//   bench         sum,count_even,uneven        sum: part1/part4, count_even: part3, uneven: part2
+//   sizes         10M                          array elements (sum, count_even)
+//   iterations    5000                         loop trip count (uneven)
+//   threads       1,2,4,...,max                team sizes
+//   variants      all                          reduction strategies, or schedule kinds for uneven
+//   chunks        0,1,64                       schedule chunks for uneven (0: the kind's default)
+//   pattern       ramp                         sum data: ramp (a[i] = i), mod (i % 1000) or random
+//   seed          DATA_SEED or 1               random data seed
+//   base-work     40                           uneven: BASE_WORK
+//   work-divisor  2500                         uneven: WORK_DIVISOR
+//   time          0.2                          measured seconds per point
+//   format        jsonl                        jsonl or csv
+//   output        -                            file, or - for stdout
+//
+// Progress goes to stderr, so stdout can be piped straight into a parser.
+
+#define MAX_LIST 32
+#define VALUE_RANGE 1000   // data values are below this for mod and random
+
+typedef struct {
+    char bench[128];
+    long long sizes[MAX_LIST];
+    int nsizes;
+    long long iterations[MAX_LIST];
+    int niterations;
+    long long threads[MAX_LIST];
+    int nthreads;
+    char variants[256];
+    long long chunks[MAX_LIST];
+    int nchunks;
+    char pattern[16];
+    unsigned long long seed;
+    int base_work;
+    int work_divisor;
+    double time;
+    char format[16];
+    char output[256];
+} suite_config_t;
+
+static const char *option_names[] = { "bench", "sizes", "iterations", "threads", "variants", "chunks", "pattern",
+                                      "seed", "base-work", "work-divisor", "time", "format", "output" };
+#define NOPTIONS ((int)(sizeof(option_names) / sizeof(option_names[0])))
+
+// "10M,1G,500" -> values; returns the count, or -1 on a malformed entry.
+static int parse_list(const char *text, long long *values, int max) {
+    int n = 0;
+    const char *p = text;
+    while (*p) {
+        char *end;
+        double v = strtod(p, &end);
+        if (end == p) return -1;
+        switch (*end) {
+        case 'k': case 'K': v *= 1e3; end++; break;
+        case 'm': case 'M': v *= 1e6; end++; break;
+        case 'g': case 'G': v *= 1e9; end++; break;
+        default: break;
+        }
+        if (*end != ',' && *end != '\0') return -1;
+        if (n == max) return -1;
+        values[n++] = (long long)v;
+        p = *end == ',' ? end + 1 : end;
+    }
+    return n;
+}
+
+static int in_list(const char *list, const char *name) {
+    if (strcmp(list, "all") == 0) return 1;
+    size_t len = strlen(name);
+    for (const char *p = list; (p = strstr(p, name)) != NULL; p += len) {
+        int starts = p == list || p[-1] == ',';
+        int ends = p[len] == '\0' || p[len] == ',';
+        if (starts && ends) return 1;
+    }
+    return 0;
+}
+
+// 1 if every comma-separated entry of list is "all" or one of names.
+static int all_known(const char *list, const char *const *names, int nnames) {
+    const char *p = list;
+    while (*p) {
+        size_t len = strcspn(p, ",");
+        int known = len == 3 && strncmp(p, "all", 3) == 0;
+        for (int k = 0; k < nnames && !known; ++k) known = strlen(names[k]) == len && strncmp(p, names[k], len) == 0;
+        if (!known) return 0;
+        p += len + (p[len] == ',');
+    }
+    return 1;
+}
+
+static const char *bench_names[] = { "sum", "count_even", "uneven" };
+static const char *schedule_names[] = { "static", "dynamic", "guided" };
+
+// Strategy names of the array benches plus the schedule kinds of uneven.
+static int variants_known(const char *list) {
+    const char *names[RE_STRATEGY_COUNT + 3];
+    int n = 0;
+    for (int k = 0; k < RE_STRATEGY_COUNT; ++k) names[n++] = re_strategy_name((re_strategy_t)k);
+    for (int k = 0; k < 3; ++k) names[n++] = schedule_names[k];
+    return all_known(list, names, n);
+}
+
+static int set_option(suite_config_t *cfg, const char *key, const char *value) {
+    int bad = 0;
+    if (strcmp(key, "bench") == 0) {
+        snprintf(cfg->bench, sizeof(cfg->bench), "%s", value);
+        bad = !*value || !all_known(value, bench_names, 3);
+    }
+    else if (strcmp(key, "sizes") == 0) {
+        bad = (cfg->nsizes = parse_list(value, cfg->sizes, MAX_LIST)) <= 0;
+        for (int s = 0; s < cfg->nsizes; ++s) bad |= cfg->sizes[s] < 1;
+    }
+    else if (strcmp(key, "iterations") == 0) {
+        bad = (cfg->niterations = parse_list(value, cfg->iterations, MAX_LIST)) <= 0;
+        for (int s = 0; s < cfg->niterations; ++s) bad |= cfg->iterations[s] < 1 || cfg->iterations[s] > INT_MAX;
+    }
+    else if (strcmp(key, "threads") == 0) {
+        bad = (cfg->nthreads = parse_list(value, cfg->threads, MAX_LIST)) <= 0;
+        for (int t = 0; t < cfg->nthreads; ++t) bad |= cfg->threads[t] < 1;
+    }
+    else if (strcmp(key, "variants") == 0) {
+        snprintf(cfg->variants, sizeof(cfg->variants), "%s", value);
+        bad = !*value || !variants_known(value);
+    }
+    else if (strcmp(key, "chunks") == 0) bad = (cfg->nchunks = parse_list(value, cfg->chunks, MAX_LIST)) <= 0;
+    else if (strcmp(key, "pattern") == 0) {
+        snprintf(cfg->pattern, sizeof(cfg->pattern), "%s", value);
+        bad = strcmp(value, "ramp") != 0 && strcmp(value, "mod") != 0 && strcmp(value, "random") != 0;
+    }
+    else if (strcmp(key, "seed") == 0) cfg->seed = strtoull(value, NULL, 0);
+    else if (strcmp(key, "base-work") == 0) bad = (cfg->base_work = atoi(value)) < 0;
+    else if (strcmp(key, "work-divisor") == 0) bad = (cfg->work_divisor = atoi(value)) <= 0;
+    else if (strcmp(key, "time") == 0) bad = (cfg->time = atof(value)) <= 0;
+    else if (strcmp(key, "format") == 0) {
+        snprintf(cfg->format, sizeof(cfg->format), "%s", value);
+        bad = strcmp(value, "jsonl") != 0 && strcmp(value, "csv") != 0;
+    }
+    else if (strcmp(key, "output") == 0) snprintf(cfg->output, sizeof(cfg->output), "%s", value);
+    else {
+        fprintf(stderr, "Unknown option '%s'\n", key);
+        return -1;
+    }
+    if (bad) fprintf(stderr, "Invalid value for %s: '%s'\n", key, value);
+    return bad ? -1 : 0;
+}
+
+static int load_config(suite_config_t *cfg, int argc, char **argv) {
+    memset(cfg, 0, sizeof(*cfg));
+    snprintf(cfg->bench, sizeof(cfg->bench), "sum,count_even,uneven");
+    cfg->sizes[0] = 10000000; cfg->nsizes = 1;
+    cfg->iterations[0] = 5000; cfg->niterations = 1;
+    int max_threads = omp_get_max_threads();
+    for (int t = 1; t < max_threads && cfg->nthreads < MAX_LIST - 1; t *= 2) cfg->threads[cfg->nthreads++] = t;
+    cfg->threads[cfg->nthreads++] = max_threads;
+    snprintf(cfg->variants, sizeof(cfg->variants), "all");
+    cfg->chunks[0] = 0; cfg->chunks[1] = 1; cfg->chunks[2] = 64; cfg->nchunks = 3;
+    snprintf(cfg->pattern, sizeof(cfg->pattern), "ramp");
+    cfg->seed = dg_seed_from_env();
+    cfg->base_work = 40;
+    cfg->work_divisor = 2500;
+    cfg->time = 0.2;
+    snprintf(cfg->format, sizeof(cfg->format), "jsonl");
+    snprintf(cfg->output, sizeof(cfg->output), "-");
+
+    for (int o = 0; o < NOPTIONS; ++o) {
+        char env[64];
+        int k = snprintf(env, sizeof(env), "SUITE_");
+        for (const char *c = option_names[o]; *c && k < (int)sizeof(env) - 1; ++c) {
+            env[k++] = *c == '-' ? '_' : (char)(*c >= 'a' && *c <= 'z' ? *c - 'a' + 'A' : *c);
+        }
+        env[k] = '\0';
+        const char *value = getenv(env);
+        if (value && *value && set_option(cfg, option_names[o], value) != 0) return -1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) return 1;
+        const char *eq = strchr(argv[i], '=');
+        if (strncmp(argv[i], "--", 2) != 0 || !eq) {
+            fprintf(stderr, "Expected --key=value, got '%s'\n", argv[i]);
+            return -1;
+        }
+        char key[64];
+        snprintf(key, sizeof(key), "%.*s", (int)(eq - argv[i] - 2), argv[i] + 2);
+        if (set_option(cfg, key, eq + 1) != 0) return -1;
+    }
+    return 0;
+}
+
+// Array benches: one engine call per run.
+typedef struct {
+    const int *data;
+    size_t n;
+    re_strategy_t strategy;
+    int count_even;
+    long long result;
+    int status;   // non-zero once any run fails to allocate
+} array_ctx_t;
+
+static void run_array(void *arg) {
+    array_ctx_t *ctx = (array_ctx_t *)arg;
+    if (ctx->count_even) ctx->status |= re_count_i32(ctx->data, ctx->n, ctx->strategy, &ctx->result);
+    else ctx->status |= re_sum_i32(ctx->data, ctx->n, ctx->strategy, &ctx->result);
+}
+
+static void fill_pattern(int *a, size_t n, const char *pattern, unsigned long long seed) {
+    if (strcmp(pattern, "mod") == 0) dg_fill_mod(a, n, VALUE_RANGE, 0);
+    else if (strcmp(pattern, "random") == 0) dg_fill_uniform(a, n, VALUE_RANGE, seed);
+    else dg_fill_ramp(a, n, 0);
+}
+
+// Returns 0, or -1 on allocation failure.
+static int sweep_array(const suite_config_t *cfg, emit_t *emit, int count_even) {
+    const char *bench = count_even ? "count_even" : "sum";
+    const char *pattern = count_even ? "random" : cfg->pattern;
+    const int initial_threads = omp_get_max_threads();
+    long long max_size = 0;
+    for (int s = 0; s < cfg->nsizes; ++s) if (cfg->sizes[s] > max_size) max_size = cfg->sizes[s];
+    numa_array_t storage;
+    if (max_size <= 0 || numa_array_alloc(&storage, (size_t)max_size) != 0) return -1;
+    fill_pattern(storage.data, (size_t)max_size, pattern, cfg->seed);
+
+    for (int s = 0; s < cfg->nsizes; ++s) {
+        size_t n = (size_t)cfg->sizes[s];
+        array_ctx_t ref = { storage.data, n, RE_SEQUENTIAL, count_even, 0, 0 };
+        run_array(&ref);
+        if (ref.status != 0) {
+            numa_array_free(&storage);
+            return -1;
+        }
+        for (int t = 0; t < cfg->nthreads; ++t) {
+            omp_set_num_threads((int)cfg->threads[t]);
+            for (int k = 0; k < RE_STRATEGY_COUNT; ++k) {
+                re_strategy_t strategy = (re_strategy_t)k;
+                if (!in_list(cfg->variants, re_strategy_name(strategy))) continue;
+                array_ctx_t ctx = { storage.data, n, strategy, count_even, 0, 0 };
+                bench_samples_t samples;
+                if (bench_run_budget(run_array, &ctx, cfg->time, &samples) != 0) {
+                    numa_array_free(&storage);
+                    return -1;
+                }
+                if (ctx.status != 0) {
+                    bench_free(&samples);
+                    numa_array_free(&storage);
+                    return -1;
+                }
+                emit_result_t r = { bench, re_strategy_name(strategy), (long long)n, (int)cfg->threads[t], &samples,
+                                    (double)n, (double)n * sizeof(int), ctx.result == ref.result,
+                                    { { "seed", (double)cfg->seed } }, strcmp(pattern, "random") == 0 };
+                emit_result(emit, &r);
+                fprintf(stderr, "%-10s %-11s n=%-11zu threads=%-3lld %.6f s %s\n", bench, re_strategy_name(strategy), n,
+                        cfg->threads[t], samples.median, r.check ? "✓" : "✗");
+                bench_free(&samples);
+            }
+        }
+    }
+    omp_set_num_threads(initial_threads);
+    numa_array_free(&storage);
+    return 0;
+}
+
+// part2's loop under schedule(runtime).
+typedef struct {
+    int n;
+    int base_work;
+    int work_divisor;
+    double result;
+} uneven_ctx_t;
+
+static void run_uneven(void *arg) {
+    uneven_ctx_t *ctx = (uneven_ctx_t *)arg;
+    double total = 0.0;
+    #pragma omp parallel for schedule(runtime) reduction(+:total)
+    for (int i = 0; i < ctx->n; ++i) total += uw_simulate(i, ctx->base_work, ctx->work_divisor);
+    ctx->result = total;
+}
+
+static int sweep_uneven(const suite_config_t *cfg, emit_t *emit) {
+    static const struct { const char *name; omp_sched_t kind; } kinds[] = {
+        { "static", omp_sched_static }, { "dynamic", omp_sched_dynamic }, { "guided", omp_sched_guided },
+    };
+    const int initial_threads = omp_get_max_threads();
+    for (int s = 0; s < cfg->niterations; ++s) {
+        int n = (int)cfg->iterations[s];
+        double reference = 0.0;
+        for (int i = 0; i < n; ++i) reference += uw_simulate(i, cfg->base_work, cfg->work_divisor);
+        for (int t = 0; t < cfg->nthreads; ++t) {
+            omp_set_num_threads((int)cfg->threads[t]);
+            for (int k = 0; k < 3; ++k) {
+                if (!in_list(cfg->variants, kinds[k].name)) continue;
+                for (int c = 0; c < cfg->nchunks; ++c) {
+                    omp_set_schedule(kinds[k].kind, (int)cfg->chunks[c]);
+                    uneven_ctx_t ctx = { n, cfg->base_work, cfg->work_divisor, 0.0 };
+                    bench_samples_t samples;
+                    if (bench_run_budget(run_uneven, &ctx, cfg->time, &samples) != 0) return -1;
+                    // summation order differs between schedules
+                    int ok = fabs(ctx.result - reference) <= 1e-9 * fmax(1.0, fabs(reference));
+                    emit_result_t r = { "uneven", kinds[k].name, n, (int)cfg->threads[t], &samples, n, 0.0, ok,
+                                        { { "chunk", (double)cfg->chunks[c] }, { "base_work", cfg->base_work },
+                                          { "work_divisor", cfg->work_divisor } }, 3 };
+                    emit_result(emit, &r);
+                    fprintf(stderr, "%-10s %-7s,%-3lld n=%-11d threads=%-3lld %.6f s %s\n", "uneven", kinds[k].name,
+                            cfg->chunks[c], n, cfg->threads[t], samples.median, ok ? "✓" : "✗");
+                    bench_free(&samples);
+                }
+            }
+        }
+    }
+    omp_set_num_threads(initial_threads);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    suite_config_t cfg;
+    int status = load_config(&cfg, argc, argv);
+    if (status != 0) {
+        fprintf(stderr, "Usage: %s [--bench=sum,count_even,uneven] [--sizes=10M] [--iterations=5000] "
+                        "[--threads=1,2,4] [--variants=all] [--chunks=0,1,64] [--pattern=ramp|mod|random] "
+                        "[--seed=N] [--base-work=40] [--work-divisor=2500] [--time=0.2] [--format=jsonl|csv] "
+                        "[--output=-]\nEvery option can also be set as SUITE_<KEY> in the environment.\n", argv[0]);
+        return status > 0 ? 0 : 2;
+    }
+
+    emit_t emit;
+    if (emit_open(&emit, cfg.output, strcmp(cfg.format, "csv") == 0 ? EMIT_CSV : EMIT_JSONL) != 0) {
+        perror(cfg.output);
+        return 1;
+    }
+    emit_host(&emit);
+
+    int failed = 0;
+    if (in_list(cfg.bench, "sum")) failed |= sweep_array(&cfg, &emit, 0);
+    if (in_list(cfg.bench, "count_even")) failed |= sweep_array(&cfg, &emit, 1);
+    if (in_list(cfg.bench, "uneven")) failed |= sweep_uneven(&cfg, &emit);
+    emit_close(&emit);
+    if (failed) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,254 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "simd_sum.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define tp_cpu_relax() _mm_pause()
+#else
+#define tp_cpu_relax() ((void)0)
+#endif
+
+// Persistent thread pool for many small parallel regions. Workers are
+// created once and wait between jobs, so a job costs one release store to
+// start and one combining tree to finish, not a runtime fork/join.
+//
+//   start    the caller publishes the job and bumps a generation counter.
+//            Idle workers spin on it for TP_SPIN_ITERS pauses, then park
+//            on a condition variable; the caller only signals when some
+//            worker has actually parked.
+//   reduce   each worker stores its partial in its own cache line, then
+//            folds in its children of a binary tree (2t+1, 2t+2) as they
+//            publish; the caller (worker 0) ends with the total. The tree
+//            doubles as the join, so a reduction needs no extra barrier.
+//   barrier  tp_barrier() is a sense-reversing centralized barrier for jobs
+//            with phases inside them (tp_run); spins, then yields.
+//
+// With more workers than online CPUs every spin steals the core from the
+// thread being waited for, so an oversubscribed pool spins 0 iterations:
+// idle workers park at once and waits yield (the libgomp throttle does the
+// same).
+//
+// tp_sum_i32 runs serially below pool->serial_below elements, the crossover
+// measured by the caller (0 = always parallel).
+
+#ifndef TP_SPIN_ITERS
+#define TP_SPIN_ITERS 20000
+#endif
+#define TP_CACHE_LINE 64
+#define TP_MAX_THREADS 256
+
+typedef long long (*tp_reduce_fn)(int tid, int nthreads, void *arg);
+
+typedef struct {
+    _Alignas(TP_CACHE_LINE) long long value;
+    atomic_long ready;   // generation whose value is complete
+    int sense;           // this worker's barrier sense
+} tp_slot_t;
+
+typedef struct {
+    _Alignas(TP_CACHE_LINE) atomic_int count;
+    atomic_int sense;
+} tp_barrier_t;
+
+typedef struct {
+    int nthreads;
+    int spin_iters;   // TP_SPIN_ITERS, or 0 when oversubscribed
+    size_t serial_below;
+    pthread_t *threads;
+    tp_slot_t *slots;
+    tp_barrier_t barrier;
+    _Alignas(TP_CACHE_LINE) atomic_long generation;
+    tp_reduce_fn fn;
+    void *arg;
+    int stop;
+    atomic_int parked;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} tp_pool_t;
+
+typedef struct {
+    tp_pool_t *pool;
+    int tid;
+} tp_worker_arg_t;
+
+// Sense-reversing barrier across all workers of the running job.
+static inline void tp_barrier(tp_pool_t *p, int tid) {
+    int *local_sense = &p->slots[tid].sense;
+    *local_sense = !*local_sense;
+    if (atomic_fetch_add_explicit(&p->barrier.count, 1, memory_order_acq_rel) == p->nthreads - 1) {
+        atomic_store_explicit(&p->barrier.count, 0, memory_order_relaxed);
+        atomic_store_explicit(&p->barrier.sense, *local_sense, memory_order_release);
+        return;
+    }
+    for (int spins = 0; atomic_load_explicit(&p->barrier.sense, memory_order_acquire) != *local_sense; ++spins) {
+        if (spins < p->spin_iters) tp_cpu_relax();
+        else sched_yield();
+    }
+}
+
+// Runs the job on worker tid and combines its subtree into slots[tid].
+static inline void tp_execute(tp_pool_t *p, int tid, long gen) {
+    long long value = p->fn(tid, p->nthreads, p->arg);
+    for (int child = 2 * tid + 1; child <= 2 * tid + 2 && child < p->nthreads; ++child) {
+        for (int spins = 0; atomic_load_explicit(&p->slots[child].ready, memory_order_acquire) != gen; ++spins) {
+            if (spins < p->spin_iters) tp_cpu_relax();
+            else sched_yield();
+        }
+        value += p->slots[child].value;
+    }
+    p->slots[tid].value = value;
+    atomic_store_explicit(&p->slots[tid].ready, gen, memory_order_release);
+}
+
+static void *tp_worker_main(void *raw) {
+    tp_worker_arg_t *w = (tp_worker_arg_t *)raw;
+    tp_pool_t *p = w->pool;
+    int tid = w->tid;
+    free(w);
+    long seen = 0;
+    for (;;) {
+        long gen;
+        int spins = 0;
+        while ((gen = atomic_load_explicit(&p->generation, memory_order_acquire)) == seen) {
+            if (spins++ < p->spin_iters) {
+                tp_cpu_relax();
+                continue;
+            }
+            pthread_mutex_lock(&p->lock);
+            atomic_fetch_add_explicit(&p->parked, 1, memory_order_seq_cst);
+            while (atomic_load_explicit(&p->generation, memory_order_seq_cst) == seen) {
+                pthread_cond_wait(&p->wake, &p->lock);
+            }
+            atomic_fetch_sub_explicit(&p->parked, 1, memory_order_relaxed);
+            pthread_mutex_unlock(&p->lock);
+            spins = 0;
+        }
+        seen = gen;
+        if (p->stop) return NULL;
+        tp_execute(p, tid, gen);
+    }
+}
+
+// Publishes a job; `p->fn` / `p->arg` must be set before the call.
+static inline long tp_start(tp_pool_t *p) {
+    long gen = atomic_fetch_add_explicit(&p->generation, 1, memory_order_seq_cst) + 1;
+    if (atomic_load_explicit(&p->parked, memory_order_seq_cst) > 0) {
+        pthread_mutex_lock(&p->lock);
+        pthread_cond_broadcast(&p->wake);
+        pthread_mutex_unlock(&p->lock);
+    }
+    return gen;
+}
+
+// Returns 0, or -1 if threads or slots cannot be created. nthreads counts
+// the caller, which acts as worker 0.
+static inline int tp_init(tp_pool_t *p, int nthreads) {
+    memset(p, 0, sizeof(*p));
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > TP_MAX_THREADS) nthreads = TP_MAX_THREADS;
+    p->nthreads = nthreads;
+    p->spin_iters = nthreads > sysconf(_SC_NPROCESSORS_ONLN) ? 0 : TP_SPIN_ITERS;
+    p->slots = (tp_slot_t *)aligned_alloc(TP_CACHE_LINE, sizeof(tp_slot_t) * (size_t)nthreads);
+    p->threads = (pthread_t *)calloc((size_t)nthreads, sizeof(pthread_t));
+    if (!p->slots || !p->threads) {
+        free(p->slots); free(p->threads);
+        return -1;
+    }
+    for (int t = 0; t < nthreads; ++t) {
+        p->slots[t].value = 0;
+        p->slots[t].sense = 0;
+        atomic_init(&p->slots[t].ready, 0);
+    }
+    atomic_init(&p->generation, 0);
+    atomic_init(&p->parked, 0);
+    atomic_init(&p->barrier.count, 0);
+    atomic_init(&p->barrier.sense, 0);
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, NULL);
+    for (int t = 1; t < nthreads; ++t) {
+        tp_worker_arg_t *w = (tp_worker_arg_t *)malloc(sizeof(tp_worker_arg_t));
+        if (w) {
+            w->pool = p;
+            w->tid = t;
+        }
+        if (!w || pthread_create(&p->threads[t], NULL, tp_worker_main, w) != 0) {
+            free(w);
+            p->nthreads = t;   // shut down the ones already running
+            p->stop = 1;
+            tp_start(p);
+            for (int k = 1; k < t; ++k) pthread_join(p->threads[k], NULL);
+            free(p->slots); free(p->threads);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static inline void tp_destroy(tp_pool_t *p) {
+    p->stop = 1;
+    tp_start(p);
+    for (int t = 1; t < p->nthreads; ++t) pthread_join(p->threads[t], NULL);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->wake);
+    free(p->slots);
+    free(p->threads);
+    p->slots = NULL;
+    p->threads = NULL;
+}
+
+// Runs fn on every worker and returns the sum of their results.
+static inline long long tp_reduce(tp_pool_t *p, tp_reduce_fn fn, void *arg) {
+    p->fn = fn;
+    p->arg = arg;
+    long gen = tp_start(p);
+    tp_execute(p, 0, gen);
+    return p->slots[0].value;
+}
+
+typedef void (*tp_run_fn)(int tid, int nthreads, void *arg);
+
+typedef struct {
+    tp_run_fn fn;
+    void *arg;
+} tp_run_job_t;
+
+static inline long long tp_run_adapter(int tid, int nthreads, void *arg) {
+    tp_run_job_t *job = (tp_run_job_t *)arg;
+    job->fn(tid, nthreads, job->arg);
+    return 0;
+}
+
+// Runs fn on every worker and waits for all of them; fn may call
+// tp_barrier(pool, tid) between its phases.
+static inline void tp_run(tp_pool_t *p, tp_run_fn fn, void *arg) {
+    tp_run_job_t job = { fn, arg };
+    tp_reduce(p, tp_run_adapter, &job);
+}
+
+typedef struct {
+    const int *a;
+    size_t n;
+    sum_kernel_fn kernel;
+} tp_sum_job_t;
+
+static inline long long tp_sum_slice(int tid, int nthreads, void *arg) {
+    tp_sum_job_t *job = (tp_sum_job_t *)arg;
+    size_t lo, hi;
+    static_range(job->n, tid, nthreads, &lo, &hi);
+    return job->kernel(job->a + lo, hi - lo);
+}
+
+static inline long long tp_sum_i32(tp_pool_t *p, sum_kernel_fn kernel, const int *a, size_t n) {
+    if (n < p->serial_below || p->nthreads == 1) return kernel(a, n);
+    tp_sum_job_t job = { a, n, kernel };
+    return tp_reduce(p, tp_sum_slice, &job);
+}
+
+#endif
@@ -0,0 +1,342 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Per-thread timeline tracing for the OpenMP regions. Build with
+// -DENABLE_TRACE to turn it on; without it every macro below expands to
+// ((void)0) and none of this file is compiled.
+//
+// The master thread names each region with TRACE_REGION_BEGIN(fmt, ...) /
+// TRACE_REGION_END(). Per-thread events come from the OMPT tool interface
+// (implicit-task begin/end and barrier waits) when <omp-tools.h> is available
+// and the runtime supports it (LLVM libomp does, libgomp does not). Events go
+// to per-thread ring buffers with no locking; the buffers are processed once,
+// at exit, into:
+//   - a Chrome trace-event JSON file (TRACE_FILE, default trace.json), and
+//   - a text summary per region: busy time, idle time at barriers and the
+//     imbalance ratio (max busy / mean busy) across threads.
+// Without OMPT only the region wall times are available.
+
+#ifdef ENABLE_TRACE
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__has_include)
+#if __has_include(<omp-tools.h>)
+#include <omp-tools.h>
+#define TRACE_HAVE_OMPT 1
+#endif
+#endif
+
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS (1u << 16)   // per thread; oldest events are overwritten
+#endif
+#define TRACE_MAX_THREADS 256
+#ifndef TRACE_MAX_REGIONS
+#define TRACE_MAX_REGIONS 4096   // part3's incremental section alone opens ~1500
+#endif
+#define TRACE_NAME_LEN 48
+
+enum { TRACE_TASK_BEGIN, TRACE_TASK_END, TRACE_WAIT_BEGIN, TRACE_WAIT_END };
+
+typedef struct {
+    double ts;
+    int kind;
+    int region;
+} trace_event_t;
+
+typedef struct {
+    trace_event_t *events;
+    unsigned long long written;
+} trace_ring_t;
+
+typedef struct {
+    char name[TRACE_NAME_LEN];
+    double begin;
+    double end;
+} trace_region_t;
+
+static trace_ring_t trace_rings[TRACE_MAX_THREADS];
+static trace_region_t trace_regions[TRACE_MAX_REGIONS];
+static atomic_int trace_region_count;
+static atomic_int trace_regions_dropped;   // begun after the table was full
+static atomic_int trace_thread_count;
+static atomic_int trace_current_region = -1;
+static _Thread_local int trace_tid = -1;
+static int trace_ompt_active;
+static double trace_epoch = -1.0;
+
+static inline double trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline void trace_record(int kind) {
+    if (trace_tid < 0) trace_tid = atomic_fetch_add(&trace_thread_count, 1);
+    if (trace_tid >= TRACE_MAX_THREADS) return;
+    trace_ring_t *ring = &trace_rings[trace_tid];
+    if (!ring->events) {
+        ring->events = (trace_event_t *)malloc(sizeof(trace_event_t) * TRACE_RING_EVENTS);
+        if (!ring->events) return;
+    }
+    trace_event_t *ev = &ring->events[ring->written % TRACE_RING_EVENTS];
+    ev->ts = trace_now();
+    ev->kind = kind;
+    ev->region = atomic_load_explicit(&trace_current_region, memory_order_relaxed);
+    ring->written++;
+}
+
+#ifdef TRACE_HAVE_OMPT
+static void trace_on_implicit_task(ompt_scope_endpoint_t endpoint, ompt_data_t *parallel_data,
+                                   ompt_data_t *task_data, unsigned int actual_parallelism,
+                                   unsigned int index, int flags) {
+    (void)parallel_data; (void)task_data; (void)actual_parallelism; (void)index;
+    if (flags & ompt_task_initial) return;
+    trace_record(endpoint == ompt_scope_begin ? TRACE_TASK_BEGIN : TRACE_TASK_END);
+}
+
+static void trace_on_sync_wait(ompt_sync_region_t kind, ompt_scope_endpoint_t endpoint,
+                               ompt_data_t *parallel_data, ompt_data_t *task_data, const void *codeptr_ra) {
+    (void)parallel_data; (void)task_data; (void)codeptr_ra;
+    if (kind == ompt_sync_region_taskwait || kind == ompt_sync_region_taskgroup ||
+        kind == ompt_sync_region_reduction) return;
+    trace_record(endpoint == ompt_scope_begin ? TRACE_WAIT_BEGIN : TRACE_WAIT_END);
+}
+
+static int trace_ompt_initialize(ompt_function_lookup_t lookup, int initial_device_num, ompt_data_t *tool_data) {
+    (void)initial_device_num; (void)tool_data;
+    ompt_set_callback_t set_callback = (ompt_set_callback_t)lookup("ompt_set_callback");
+    if (!set_callback) return 0;
+    int ok = set_callback(ompt_callback_implicit_task, (ompt_callback_t)trace_on_implicit_task) == ompt_set_always;
+    ok &= set_callback(ompt_callback_sync_region_wait, (ompt_callback_t)trace_on_sync_wait) == ompt_set_always;
+    trace_ompt_active = ok;
+    return 1;
+}
+
+static void trace_ompt_finalize(ompt_data_t *tool_data) {
+    (void)tool_data;
+}
+
+// Entry point the OpenMP runtime looks up at startup.
+ompt_start_tool_result_t *ompt_start_tool(unsigned int omp_version, const char *runtime_version) {
+    (void)omp_version; (void)runtime_version;
+    static ompt_start_tool_result_t result = { trace_ompt_initialize, trace_ompt_finalize, {0} };
+    return &result;
+}
+#endif
+
+// Runtimes may deliver a worker's implicit-task-end and barrier-wait-end
+// only when the worker is released into the next region (libomp does).
+// End events therefore belong to the region of their matching begin and
+// are clamped to that region's end.
+static inline double trace_end_time(const trace_event_t *ev, int open_region) {
+    if (open_region < 0) return ev->ts;
+    double region_end = trace_regions[open_region].end;
+    return ev->ts < region_end ? ev->ts : region_end;
+}
+
+// Region names come from caller format strings; quote them as JSON.
+static void trace_json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20) fprintf(out, "\\u%04x", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+static void trace_write_json(const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) { perror(path); return; }
+    int regions = atomic_load(&trace_region_count);
+    int threads = atomic_load(&trace_thread_count);
+    if (threads > TRACE_MAX_THREADS) threads = TRACE_MAX_THREADS;
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"regions\"}}",
+            TRACE_MAX_THREADS);
+    for (int r = 0; r < regions; ++r) {
+        const trace_region_t *reg = &trace_regions[r];
+        fprintf(out, ",\n{\"name\":");
+        trace_json_string(out, reg->name);
+        fprintf(out, ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                TRACE_MAX_THREADS, (reg->begin - trace_epoch) * 1e6, (reg->end - reg->begin) * 1e6);
+    }
+    for (int t = 0; t < threads; ++t) {
+        const trace_ring_t *ring = &trace_rings[t];
+        if (!ring->events) continue;
+        unsigned long long start = ring->written > TRACE_RING_EVENTS ? ring->written - TRACE_RING_EVENTS : 0;
+        int task_region = -1, wait_region = -1;
+        for (unsigned long long k = start; k < ring->written; ++k) {
+            const trace_event_t *ev = &ring->events[k % TRACE_RING_EVENTS];
+            int is_wait = ev->kind == TRACE_WAIT_BEGIN || ev->kind == TRACE_WAIT_END;
+            int is_begin = ev->kind == TRACE_TASK_BEGIN || ev->kind == TRACE_WAIT_BEGIN;
+            int region = is_begin ? ev->region : is_wait ? wait_region : task_region;
+            double ts = is_begin ? ev->ts : trace_end_time(ev, region);
+            if (ev->kind == TRACE_TASK_BEGIN) task_region = ev->region;
+            if (ev->kind == TRACE_TASK_END) task_region = -1;
+            if (ev->kind == TRACE_WAIT_BEGIN) wait_region = ev->region;
+            if (ev->kind == TRACE_WAIT_END) wait_region = -1;
+            const char *name = is_wait ? "barrier wait"
+                             : region >= 0 ? trace_regions[region].name : "unnamed region";
+            fprintf(out, ",\n{\"name\":");
+            trace_json_string(out, name);
+            fprintf(out, ",\"ph\":\"%s\",\"pid\":0,\"tid\":%d,\"ts\":%.3f}",
+                    is_begin ? "B" : "E", t, (ts - trace_epoch) * 1e6);
+        }
+        // the last region's end events may never arrive before exit
+        if (wait_region >= 0) {
+            fprintf(out, ",\n{\"name\":\"barrier wait\",\"ph\":\"E\",\"pid\":0,\"tid\":%d,\"ts\":%.3f}",
+                    t, (trace_regions[wait_region].end - trace_epoch) * 1e6);
+        }
+        if (task_region >= 0) {
+            fprintf(out, ",\n{\"name\":");
+            trace_json_string(out, trace_regions[task_region].name);
+            fprintf(out, ",\"ph\":\"E\",\"pid\":0,\"tid\":%d,\"ts\":%.3f}",
+                    t, (trace_regions[task_region].end - trace_epoch) * 1e6);
+        }
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+}
+
+static void trace_print_summary(void) {
+    int regions = atomic_load(&trace_region_count);
+    int threads = atomic_load(&trace_thread_count);
+    if (threads > TRACE_MAX_THREADS) threads = TRACE_MAX_THREADS;
+    double *busy = (double *)calloc((size_t)regions * (threads ? threads : 1), sizeof(double));
+    double *idle = (double *)calloc((size_t)regions * (threads ? threads : 1), sizeof(double));
+    if (!busy || !idle) { free(busy); free(idle); return; }
+
+    int wrapped = 0;
+    for (int t = 0; t < threads; ++t) {
+        const trace_ring_t *ring = &trace_rings[t];
+        if (!ring->events) continue;
+        unsigned long long start = 0;
+        if (ring->written > TRACE_RING_EVENTS) { start = ring->written - TRACE_RING_EVENTS; wrapped = 1; }
+        double task_begin = -1.0, wait_begin = -1.0;
+        int task_region = -1, wait_region = -1;
+        for (unsigned long long k = start; k < ring->written; ++k) {
+            const trace_event_t *ev = &ring->events[k % TRACE_RING_EVENTS];
+            switch (ev->kind) {
+                case TRACE_TASK_BEGIN:
+                    task_begin = ev->ts;
+                    task_region = ev->region;
+                    break;
+                case TRACE_TASK_END:
+                    if (task_begin >= 0 && task_region >= 0 && task_region < regions) {
+                        busy[(size_t)task_region * threads + t] += trace_end_time(ev, task_region) - task_begin;
+                    }
+                    task_begin = -1.0;
+                    break;
+                case TRACE_WAIT_BEGIN:
+                    wait_begin = ev->ts;
+                    wait_region = ev->region;
+                    break;
+                case TRACE_WAIT_END:
+                    if (wait_begin >= 0 && wait_region >= 0 && wait_region < regions) {
+                        idle[(size_t)wait_region * threads + t] += trace_end_time(ev, wait_region) - wait_begin;
+                    }
+                    wait_begin = -1.0;
+                    break;
+            }
+        }
+        // the last region's end events may never arrive before exit
+        if (task_begin >= 0 && task_region >= 0 && task_region < regions) {
+            busy[(size_t)task_region * threads + t] += trace_regions[task_region].end - task_begin;
+        }
+        if (wait_begin >= 0 && wait_region >= 0 && wait_region < regions) {
+            idle[(size_t)wait_region * threads + t] += trace_regions[wait_region].end - wait_begin;
+        }
+    }
+
+    printf("\n=== TRACE SUMMARY ===\n");
+    if (!trace_ompt_active) {
+        printf("(no OMPT-capable runtime: region wall times only)\n");
+    }
+    printf("%-32s %10s %7s %10s %10s %10s %9s\n", "Region", "Wall (s)", "Threads",
+           "Busy avg", "Busy max", "Idle avg", "Imbalance");
+    for (int r = 0; r < regions; ++r) {
+        double busy_sum = 0.0, busy_max = 0.0, idle_sum = 0.0;
+        int active = 0;
+        for (int t = 0; t < threads; ++t) {
+            size_t slot = (size_t)r * threads + t;
+            // implicit-task spans include the barrier wait at their end
+            double b = busy[slot] - idle[slot];
+            if (busy[slot] <= 0.0) continue;
+            active++;
+            busy_sum += b;
+            idle_sum += idle[slot];
+            if (b > busy_max) busy_max = b;
+        }
+        const trace_region_t *reg = &trace_regions[r];
+        if (active == 0) {
+            printf("%-32s %10.6f %7s\n", reg->name, reg->end - reg->begin, "-");
+            continue;
+        }
+        double busy_mean = busy_sum / active;
+        printf("%-32s %10.6f %7d %10.6f %10.6f %10.6f %9.3f\n", reg->name, reg->end - reg->begin, active,
+               busy_mean, busy_max, idle_sum / active, busy_mean > 0 ? busy_max / busy_mean : 1.0);
+    }
+    if (wrapped) printf("(ring buffers wrapped; oldest events were dropped)\n");
+    int dropped = atomic_load(&trace_regions_dropped);
+    if (dropped) {
+        printf("(%d regions past TRACE_MAX_REGIONS=%d were not recorded; their events are \"unnamed region\")\n",
+               dropped, TRACE_MAX_REGIONS);
+    }
+    free(busy);
+    free(idle);
+}
+
+static void trace_finish(void) {
+    const char *path = getenv("TRACE_FILE");
+    trace_print_summary();
+    trace_write_json(path ? path : "trace.json");
+    printf("Trace written to %s\n", path ? path : "trace.json");
+}
+
+static void trace_region_begin(const char *fmt, ...) {
+    double now = trace_now();
+    if (trace_epoch < 0) {
+        trace_epoch = now;
+        atexit(trace_finish);
+    }
+    int idx = atomic_load(&trace_region_count);
+    if (idx >= TRACE_MAX_REGIONS) {
+        atomic_fetch_add(&trace_regions_dropped, 1);
+        return;
+    }
+    trace_region_t *reg = &trace_regions[idx];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(reg->name, sizeof(reg->name), fmt, args);
+    va_end(args);
+    reg->begin = now;
+    reg->end = now;
+    atomic_store(&trace_region_count, idx + 1);
+    atomic_store(&trace_current_region, idx);
+}
+
+static void trace_region_end(void) {
+    int idx = atomic_exchange(&trace_current_region, -1);
+    if (idx >= 0) trace_regions[idx].end = trace_now();
+}
+
+#define TRACE_REGION_BEGIN(...) trace_region_begin(__VA_ARGS__)
+#define TRACE_REGION_END() trace_region_end()
+
+#else
+
+#define TRACE_REGION_BEGIN(...) ((void)0)
+#define TRACE_REGION_END() ((void)0)
+
+#endif
+
+#endif
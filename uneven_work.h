@@ -0,0 +1,26 @@
+#ifndef UNEVEN_WORK_H
+#define UNEVEN_WORK_H
+
+// The irregular per-iteration workload of part2: iteration i spins for
+// base + i^2 / divisor inner steps, so cost grows quadratically along the
+// loop. Shared with the suite runner, which takes base and divisor at run
+// time instead of as BASE_WORK / WORK_DIVISOR.
+
+// Inner-loop trip count of iteration i; also the closed-form cost model
+// used by the weighted static partitioner.
+static inline int uw_work_amount(int iteration, int base, int divisor) {
+    return base + (int)((1.0 * iteration * iteration) / divisor);
+}
+
+static inline double uw_simulate(int iteration, int base, int divisor) {
+    int work_amount = uw_work_amount(iteration, base, divisor);
+
+    volatile double acc = 0.0; 
+    for (int k = 0; k < work_amount; ++k) {
+        acc += (iteration * 1315423911u + k * 2654435761u) * 1e-12;
+        acc -= (k & 7) * 1e-12;
+    }
+    return acc;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef WEIGHTED_PARTITION_H
+#define WEIGHTED_PARTITION_H
+
+#include <stdlib.h>
+#include <string.h>
+
+// Weighted static partitioning: cut [0, n) into nparts contiguous blocks of
+// (nearly) equal total cost, so a loop with known skew can run with the
+// zero-coordination cost of schedule(static) and still finish balanced.
+// Block p is [bounds[p], bounds[p+1]); bounds holds nparts + 1 entries.
+//
+// The cost can come from a closed-form per-iteration function, a
+// precomputed prefix sum, or be learned from a timed first pass
+// (wp_adaptive_t), in which case the partition is reused on later runs.
+
+typedef double (*wp_cost_fn)(int i, void *ctx);
+
+// prefix[i] = cost of iterations [0, i); prefix has n + 1 entries.
+static inline void wp_partition_prefix(const double *prefix, int n, int nparts, int *bounds) {
+    double total = prefix[n];
+    bounds[0] = 0;
+    for (int p = 1; p < nparts; ++p) {
+        double target = total * p / nparts;
+        int lo = bounds[p - 1], hi = n;
+        while (lo < hi) {   // first i with prefix[i] >= target
+            int mid = lo + (hi - lo) / 2;
+            if (prefix[mid] < target) lo = mid + 1; else hi = mid;
+        }
+        if (lo > bounds[p - 1] && target - prefix[lo - 1] < prefix[lo] - target) lo--;
+        bounds[p] = lo;
+    }
+    bounds[nparts] = n;
+}
+
+static inline int wp_partition_cost(int n, wp_cost_fn cost, void *ctx, int nparts, int *bounds) {
+    double *prefix = (double *)malloc(sizeof(double) * ((size_t)n + 1));
+    if (!prefix) return -1;
+    prefix[0] = 0.0;
+    for (int i = 0; i < n; ++i) prefix[i + 1] = prefix[i] + cost(i, ctx);
+    wp_partition_prefix(prefix, n, nparts, bounds);
+    free(prefix);
+    return 0;
+}
+
+#ifndef WP_LEARN_BLOCK
+#define WP_LEARN_BLOCK 16   // iterations per timed block in the learning pass
+#endif
+
+// Adaptive mode: the first run times blocks of WP_LEARN_BLOCK iterations
+// (wp_adaptive_record), then wp_adaptive_finish turns the timings into a
+// partition. Later runs with the same n and team size reuse it.
+typedef struct {
+    int n;
+    int nparts;
+    int learned;
+    int *bounds;
+    double *block_time;
+} wp_adaptive_t;
+
+static inline int wp_adaptive_blocks(int n) { return (n + WP_LEARN_BLOCK - 1) / WP_LEARN_BLOCK; }
+
+// Returns 1 if a learning pass is needed (first use, or n / team changed).
+static inline int wp_adaptive_begin(wp_adaptive_t *ad, int n, int nparts) {
+    if (ad->learned && ad->n == n && ad->nparts == nparts) return 0;
+    free(ad->bounds);
+    free(ad->block_time);
+    ad->n = n;
+    ad->nparts = nparts;
+    ad->learned = 0;
+    ad->bounds = (int *)malloc(sizeof(int) * ((size_t)nparts + 1));
+    ad->block_time = (double *)calloc((size_t)wp_adaptive_blocks(n), sizeof(double));
+    return 1;
+}
+
+static inline void wp_adaptive_record(wp_adaptive_t *ad, int block, double seconds) {
+    ad->block_time[block] = seconds;
+}
+
+// Spread each block's time evenly over its iterations and partition.
+static inline int wp_adaptive_finish(wp_adaptive_t *ad) {
+    int n = ad->n;
+    double *prefix = (double *)malloc(sizeof(double) * ((size_t)n + 1));
+    if (!prefix || !ad->bounds) { free(prefix); return -1; }
+    prefix[0] = 0.0;
+    for (int i = 0; i < n; ++i) {
+        int block = i / WP_LEARN_BLOCK;
+        int len = (block + 1) * WP_LEARN_BLOCK <= n ? WP_LEARN_BLOCK : n - block * WP_LEARN_BLOCK;
+        prefix[i + 1] = prefix[i] + ad->block_time[block] / len;
+    }
+    wp_partition_prefix(prefix, n, ad->nparts, ad->bounds);
+    free(prefix);
+    ad->learned = 1;
+    return 0;
+}
+
+static inline void wp_adaptive_free(wp_adaptive_t *ad) {
+    free(ad->bounds);
+    free(ad->block_time);
+    memset(ad, 0, sizeof(*ad));
+}
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef WORKSTEAL_H
+#define WORKSTEAL_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ws_cpu_relax() _mm_pause()
+#else
+#define ws_cpu_relax() ((void)0)
+#endif
+
+// Work-stealing loop runtime. Every worker owns a Chase-Lev deque of
+// iteration ranges and starts with its schedule(static) block. A worker
+// splits the range it is about to run in half repeatedly, pushing the upper
+// halves, until it is down to `grain` iterations; thieves take from the top
+// of a victim's deque, which always holds the victim's largest pending half.
+// Only idle workers touch shared state: finished iterations are counted
+// privately and published to the shared `remaining` count once per dry
+// deque, so the busy path costs one uncontended deque push/pop per split
+// instead of an atomic per chunk.
+//
+// Deque operations follow Le, Pop, Cohen, Zappa Nardelli, "Correct and
+// Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013). A range is
+// packed into one 64-bit slot so a thief reads it atomically. Binary
+// splitting keeps at most log2(n) entries per deque, so the buffer is fixed.
+
+#define WS_DEQUE_CAPACITY 64
+#define WS_CACHE_LINE 64
+
+typedef struct {
+    _Alignas(WS_CACHE_LINE) atomic_long top;
+    _Alignas(WS_CACHE_LINE) atomic_long bottom;
+    _Alignas(WS_CACHE_LINE) _Atomic uint64_t slots[WS_DEQUE_CAPACITY];
+} ws_deque_t;
+
+typedef struct {
+    _Alignas(WS_CACHE_LINE) long long steals;
+    long long failed_steals;
+    long long ranges;          // grains executed
+    double busy_time;          // seconds inside the loop body
+} ws_thread_stats_t;
+
+// Body for iterations [lo, hi), run on worker `tid`.
+typedef void (*ws_body_fn)(int lo, int hi, int tid, void *ctx);
+
+static inline uint64_t ws_pack(int lo, int hi) { return (uint64_t)(uint32_t)lo << 32 | (uint32_t)hi; }
+static inline int ws_lo(uint64_t r) { return (int)(uint32_t)(r >> 32); }
+static inline int ws_hi(uint64_t r) { return (int)(uint32_t)r; }
+
+static inline int ws_push(ws_deque_t *q, uint64_t range) {
+    long b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    if (b - t >= WS_DEQUE_CAPACITY) return 0;
+    atomic_store_explicit(&q->slots[b % WS_DEQUE_CAPACITY], range, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    return 1;
+}
+
+// Owner end; returns 0 when the deque is empty or the last entry was stolen.
+static inline int ws_take(ws_deque_t *q, uint64_t *range) {
+    long b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&q->top, memory_order_relaxed);
+    int ok = 1;
+    if (t <= b) {
+        *range = atomic_load_explicit(&q->slots[b % WS_DEQUE_CAPACITY], memory_order_relaxed);
+        if (t == b) {
+            if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed)) {
+                ok = 0;
+            }
+            atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        ok = 0;
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    }
+    return ok;
+}
+
+// Thief end; returns 0 when the deque was empty or another thread won.
+static inline int ws_steal(ws_deque_t *q, uint64_t *range) {
+    long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+    if (t >= b) return 0;
+    *range = atomic_load_explicit(&q->slots[t % WS_DEQUE_CAPACITY], memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+                                                   memory_order_seq_cst, memory_order_relaxed);
+}
+
+// Split-then-run: keep the lower half, publish the upper half, repeat.
+// Finished iterations go to the caller's private `done` count.
+static inline void ws_execute(ws_deque_t *q, uint64_t range, int grain, ws_body_fn body, void *ctx,
+                              int tid, ws_thread_stats_t *st, long *done) {
+    int lo = ws_lo(range), hi = ws_hi(range);
+    while (hi - lo > grain) {
+        int mid = lo + (hi - lo) / 2;
+        if (!ws_push(q, ws_pack(mid, hi))) break;
+        hi = mid;
+    }
+    double t0 = omp_get_wtime();
+    body(lo, hi, tid, ctx);
+    st->busy_time += omp_get_wtime() - t0;
+    st->ranges++;
+    *done += hi - lo;
+}
+
+// Run iterations [0, n) over the current OpenMP team. `stats` must hold
+// omp_get_max_threads() entries; the team size actually used is returned.
+static inline int ws_parallel_for(int n, int grain, ws_body_fn body, void *ctx, ws_thread_stats_t *stats) {
+    int max_threads = omp_get_max_threads();
+    ws_deque_t *deques = (ws_deque_t *)aligned_alloc(WS_CACHE_LINE, sizeof(ws_deque_t) * (size_t)max_threads);
+    atomic_long remaining;
+    int team = 0;
+    if (!deques) return 0;
+    if (grain < 1) grain = 1;
+    memset(stats, 0, sizeof(ws_thread_stats_t) * (size_t)max_threads);
+    atomic_init(&remaining, n);
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        ws_deque_t *mine = &deques[tid];
+        ws_thread_stats_t *st = &stats[tid];
+        unsigned seed = 2463534242u ^ (unsigned)(tid * 0x9E3779B9u);
+
+        atomic_init(&mine->top, 0);
+        atomic_init(&mine->bottom, 0);
+        int lo = (int)((long long)n * tid / nthreads);
+        int hi = (int)((long long)n * (tid + 1) / nthreads);
+        if (hi > lo) ws_push(mine, ws_pack(lo, hi));
+        if (tid == 0) team = nthreads;
+        #pragma omp barrier
+
+        long done = 0;
+        for (;;) {
+            uint64_t range;
+            while (ws_take(mine, &range)) ws_execute(mine, range, grain, body, ctx, tid, st, &done);
+            // own deque is dry: publish what this worker finished, once,
+            // before deciding between stealing and stopping
+            if (done) {
+                atomic_fetch_sub_explicit(&remaining, done, memory_order_release);
+                done = 0;
+            }
+            if (atomic_load_explicit(&remaining, memory_order_acquire) <= 0) break;
+            if (nthreads == 1) continue;
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;   // xorshift32
+            int victim = (int)(seed % (unsigned)(nthreads - 1));
+            if (victim >= tid) victim++;
+            if (ws_steal(&deques[victim], &range)) {
+                st->steals++;
+                ws_execute(mine, range, grain, body, ctx, tid, st, &done);
+            } else {
+                st->failed_steals++;
+                ws_cpu_relax();
+            }
+        }
+    }
+
+    free(deques);
+    return team;
+}
+
+#endif